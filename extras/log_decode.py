@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""
+Decode the binary log stream written by ArduLiteESP_Log.h.
+
+Format strings are looked up in the firmware ELF by address, so they are
+never sent over the wire.
+
+    python3 log_decode.py firmware.elf /dev/ttyUSB0 --baud 921600
+    python3 log_decode.py firmware.elf capture.bin
+
+Reading a serial port needs pyserial (pip install pyserial); files and
+stdin ("-") need nothing beyond the standard library.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+PACKET_TYPE = 0x4C
+LEVELS = {1: "E", 2: "W", 3: "I", 4: "D"}
+
+TAG_DROPPED = 0x01
+TAG_INT = 0x02
+TAG_UINT = 0x03
+TAG_FLOAT = 0x04
+TAG_BOOL = 0x05
+TAG_CHAR = 0x06
+TAG_STRING = 0x07
+PARAM_NEWLINE = 0x80
+
+SPECIFIER = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t)?([diuxXoeEfFgGcsp%])")
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class Elf:
+    """Minimal ELF32 little-endian reader: maps addresses to section bytes."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise ValueError("expected a 32-bit ELF file")
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for n in range(shnum):
+            (_, sh_type, _, addr, offset, size) = struct.unpack_from(
+                "<IIIIII", self.data, shoff + n * shentsize)
+            if addr and sh_type == 1:  # SHT_PROGBITS
+                self.sections.append((addr, offset, size))
+
+    def string(self, address):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.find(b"\0", start, offset + size)
+                return self.data[start:end].decode("utf-8", "replace")
+        return None
+
+
+def convert(spec, word, elf):
+    if spec in "di":
+        return struct.unpack("<i", struct.pack("<I", word))[0]
+    if spec in "eEfFgG":
+        return struct.unpack("<f", struct.pack("<I", word))[0]
+    if spec == "c":
+        return chr(word & 0xFF)
+    if spec == "s":
+        text = elf.string(word) if elf else None
+        return text if text is not None else "<0x%08x>" % word
+    return word
+
+
+def format_record(fmt, args, elf):
+    words = iter(args)
+
+    def replace(match):
+        flags, _, spec = match.groups()
+        if spec == "%":
+            return "%"
+        try:
+            word = next(words)
+        except StopIteration:
+            return match.group(0)
+        if spec == "p":
+            return "0x%08x" % word
+        if spec == "u":
+            spec = "d"
+        return ("%" + flags + spec) % convert(match.group(3), word, elf)
+
+    return SPECIFIER.sub(replace, fmt)
+
+
+def format_value(tag, param, args):
+    base = param & 0x7F
+    word = args[0] if args else 0
+    if tag == TAG_STRING:
+        return struct.pack("<%dI" % len(args), *args).split(b"\0")[0].decode("utf-8", "replace")
+    if tag == TAG_FLOAT:
+        value = struct.unpack("<f", struct.pack("<I", word))[0]
+        return "%.*f" % (base if base else 2, value)
+    if tag == TAG_BOOL:
+        return "true" if word else "false"
+    if tag == TAG_CHAR:
+        return chr(word & 0xFF)
+    if tag == TAG_INT:
+        value = struct.unpack("<i", struct.pack("<I", word))[0]
+    else:
+        value = word
+    if base in (2, 8, 16):
+        return {2: "{:b}", 8: "{:o}", 16: "{:x}"}[base].format(value & 0xFFFFFFFF)
+    return str(value)
+
+
+class Decoder:
+    def __init__(self, elf, out):
+        self.elf = elf
+        self.out = out
+        self.pending = ""  # debug() values waiting for debugLine()
+        self.pending_time = 0
+
+    def packet(self, payload):
+        if len(payload) < 3 + 11 or payload[0] != PACKET_TYPE:
+            return
+        body, crc = payload[:-2], struct.unpack("<H", payload[-2:])[0]
+        if crc16_ccitt(body) != crc:
+            self.out.write("<crc error>\n")
+            return
+        record = body[1:]
+        ident, time_us, level, param, argc = struct.unpack_from("<IIBBB", record)
+        args = list(struct.unpack_from("<%dI" % argc, record, 11))
+
+        if ident == TAG_DROPPED:
+            self.line(time_us, "W", "<%d log records dropped>" % args[0])
+        elif ident < 0x100:
+            if not self.pending:
+                self.pending_time = time_us
+            self.pending += format_value(ident, param, args)
+            if param & PARAM_NEWLINE:
+                self.line(self.pending_time, "D", self.pending)
+                self.pending = ""
+        else:
+            fmt = self.elf.string(ident) if self.elf else None
+            if fmt is None:
+                text = "<format 0x%08x> %s" % (ident, " ".join("0x%x" % a for a in args))
+            else:
+                text = format_record(fmt, args, self.elf)
+            self.line(time_us, LEVELS.get(level, "?"), text)
+
+    def line(self, time_us, level, text):
+        self.out.write("%10.6f %s %s\n" % (time_us / 1e6, level, text))
+        self.out.flush()
+
+
+def read_chunks(source, baud):
+    if source == "-":
+        stream = sys.stdin.buffer
+    elif source.startswith("/dev/") or source.upper().startswith("COM"):
+        import serial
+        stream = serial.Serial(source, baud, timeout=0.1)
+    else:
+        stream = open(source, "rb")
+    while True:
+        chunk = stream.read(256)
+        if chunk is None:
+            continue
+        if not chunk and not hasattr(stream, "baudrate"):
+            return
+        yield chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="firmware ELF with the format strings")
+    parser.add_argument("source", help="serial port, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    options = parser.parse_args()
+
+    decoder = Decoder(Elf(options.elf), sys.stdout)
+    frame = bytearray()
+    for chunk in read_chunks(options.source, options.baud):
+        for byte in chunk:
+            if byte == 0:
+                if frame:
+                    payload = cobs_decode(bytes(frame))
+                    if payload is not None:
+                        decoder.packet(payload)
+                    frame.clear()
+            else:
+                frame.append(byte)
+
+
+if __name__ == "__main__":
+    main()
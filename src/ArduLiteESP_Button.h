@@ -32,20 +32,21 @@ public:
         last_state = current_state;
     }
 
-    void update() {
+    // Pass a shared Instant::now() snapshot when updating many objects per pass
+    void update(const Instant& t = Instant::now()) {
         bool reading = readRaw();
-        uint32_t now = millis();
+        uint32_t now_ms = t.millis();
 
         if (reading != last_state) {
-            last_debounce_time = now;
+            last_debounce_time = now_ms;
         }
 
-        if ((now - last_debounce_time) > debounce_time) {
+        if ((now_ms - last_debounce_time) > debounce_time) {
             if (reading != current_state) {
                 current_state = reading;
 
                 if (current_state) {
-                    press_time = now;
+                    press_time = now_ms;
                 }
             }
         }
@@ -53,34 +54,34 @@ public:
         last_state = reading;
     }
 
-    bool read() {
-        update();
+    bool read(const Instant& t = Instant::now()) {
+        update(t);
         return current_state;
     }
 
-    bool pressed() {
-        update();
+    bool pressed(const Instant& t = Instant::now()) {
+        update(t);
         bool result = (current_state && current_state != last_state);
         return result;
     }
 
-    bool released() {
-        update();
+    bool released(const Instant& t = Instant::now()) {
+        update(t);
         bool result = (!current_state && current_state != last_state);
         return result;
     }
 
-    bool held(uint32_t hold_time_ms = 1000) {
-        update();
+    bool held(uint32_t hold_time_ms = 1000, const Instant& t = Instant::now()) {
+        update(t);
         if (current_state && press_time > 0) {
-            return (millis() - press_time) >= hold_time_ms;
+            return (t.millis() - press_time) >= hold_time_ms;
         }
         return false;
     }
 
-    uint32_t pressDuration() const {
+    uint32_t pressDuration(const Instant& t = Instant::now()) const {
         if (current_state && press_time > 0) {
-            return millis() - press_time;
+            return t.millis() - press_time;
         }
         return 0;
     }
@@ -0,0 +1,232 @@
+#ifndef ARDULITEESP_COBS_H
+#define ARDULITEESP_COBS_H
+
+// Binary packet framing: COBS (Consistent Overhead Byte Stuffing) with a
+// CRC-16 trailer and a 0x00 frame delimiter. Depends only on the C
+// library, so the same encoder/decoder builds on the host side.
+//
+// Frame on the wire:
+//   COBS( type | payload | crc16_lo | crc16_hi ) 0x00
+// The CRC is CRC-16/CCITT-FALSE over type and payload.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "ArduLiteESP_Callback.h"
+
+#define PACKET_DELIMITER                    0x00
+#define PACKET_OVERHEAD                     3     // Type byte + CRC
+
+// Worst-case encoded size of `length` raw bytes, delimiter included
+#define COBS_MAX_ENCODED_SIZE(length)       ((length) + (length) / 254 + 2)
+
+// ==================== CRC-16/CCITT ====================
+struct PacketCRC16Table {
+    uint16_t entry[256];
+
+    constexpr PacketCRC16Table() : entry() {
+        for (uint16_t i = 0; i < 256; i++) {
+            uint16_t crc = i << 8;
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+            }
+            entry[i] = crc;
+        }
+    }
+};
+
+struct PacketCRC16 {
+    inline static constexpr uint16_t INIT = 0xFFFF;
+    inline static constexpr PacketCRC16Table TABLE{};
+
+    static uint16_t update(uint16_t crc, const uint8_t* data, size_t length) {
+        while (length--) {
+            crc = (uint16_t)(crc << 8) ^ TABLE.entry[(uint8_t)(crc >> 8) ^ *data++];
+        }
+        return crc;
+    }
+
+    static uint16_t compute(const uint8_t* data, size_t length) {
+        return update(INIT, data, length);
+    }
+};
+
+// ==================== COBS ENCODER ====================
+// Streams raw bytes into COBS form in `out`, which must hold
+// COBS_MAX_ENCODED_SIZE() of everything put().
+class COBSEncoder {
+private:
+    uint8_t* out;
+    size_t position;
+    size_t code_index;
+    uint8_t code;
+
+public:
+    explicit COBSEncoder(uint8_t* buffer)
+        : out(buffer), position(1), code_index(0), code(1) {
+    }
+
+    void put(const uint8_t* data, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            if (data[i] == 0) {
+                out[code_index] = code;
+                code_index = position++;
+                code = 1;
+            } else {
+                out[position++] = data[i];
+                if (++code == 0xFF) {
+                    out[code_index] = code;
+                    code_index = position++;
+                    code = 1;
+                }
+            }
+        }
+    }
+
+    // Close the last block and append the delimiter; returns the frame size
+    size_t finish() {
+        out[code_index] = code;
+        out[position++] = PACKET_DELIMITER;
+        return position;
+    }
+};
+
+// (type, payload, length); a plain function or a capturing lambda
+using PacketHandler = Callback<void(uint8_t type, const uint8_t* data, size_t length)>;
+
+// ==================== PACKET DECODER ====================
+// Incremental COBS decoder. Feed it any slice of the byte stream; each
+// complete frame with a valid CRC is passed to the handler as
+// (type, payload, length). Corrupt or oversized frames are counted and
+// dropped, and decoding resynchronises on the next delimiter.
+template<size_t MAX_PAYLOAD = 128>
+class PacketDecoder {
+private:
+    inline static constexpr size_t CAPACITY = MAX_PAYLOAD + PACKET_OVERHEAD;
+
+    uint8_t buffer[CAPACITY];
+    size_t length;
+    uint8_t remaining;      // Data bytes left in the current block
+    bool pending_zero;      // Previous block ended with an encoded zero
+    bool overflow;
+    uint32_t frame_count;
+    uint32_t error_count;
+    PacketHandler handler;
+
+    void reset() {
+        length = 0;
+        remaining = 0;
+        pending_zero = false;
+        overflow = false;
+    }
+
+    void append(const uint8_t* data, size_t count) {
+        if (overflow) return;
+        if (length + count > CAPACITY) {
+            overflow = true;
+            return;
+        }
+        memcpy(&buffer[length], data, count);
+        length += count;
+    }
+
+    void endFrame() {
+        if (length == 0 && remaining == 0 && !overflow) return;  // Back-to-back delimiters
+
+        if (overflow || remaining != 0 || length < PACKET_OVERHEAD) {
+            error_count++;
+        } else {
+            size_t body = length - 2;
+            uint16_t crc = buffer[body] | ((uint16_t)buffer[body + 1] << 8);
+            if (PacketCRC16::compute(buffer, body) != crc) {
+                error_count++;
+            } else {
+                frame_count++;
+                if (handler) handler(buffer[0], &buffer[1], body - 1);
+            }
+        }
+        reset();
+    }
+
+public:
+    PacketDecoder() : frame_count(0), error_count(0), handler(nullptr) {
+        reset();
+    }
+
+    void setHandler(PacketHandler callback) {
+        handler = callback;
+    }
+
+    void feed(const uint8_t* data, size_t count) {
+        const uint8_t* end = data + count;
+
+        while (data < end) {
+            if (remaining == 0) {
+                // Code byte or delimiter
+                uint8_t code = *data++;
+                if (code == PACKET_DELIMITER) {
+                    endFrame();
+                    continue;
+                }
+                if (pending_zero) {
+                    static const uint8_t zero = 0;
+                    append(&zero, 1);
+                }
+                remaining = code - 1;
+                pending_zero = (code != 0xFF);
+                continue;
+            }
+
+            // Copy as much of the block as this slice holds; a zero inside a
+            // block means the frame was cut short
+            size_t run = (size_t)(end - data) < remaining ? (size_t)(end - data) : remaining;
+            const uint8_t* zero = (const uint8_t*)memchr(data, PACKET_DELIMITER, run);
+            if (zero) run = zero - data;
+
+            append(data, run);
+            data += run;
+            remaining -= run;
+
+            if (zero) {
+                data++;
+                error_count++;
+                reset();
+            }
+        }
+    }
+
+    uint32_t getFrameCount() const {
+        return frame_count;
+    }
+
+    uint32_t getErrorCount() const {
+        return error_count;
+    }
+};
+
+// ==================== PACKET HELPERS ====================
+// Encode one frame into `out` (COBS_MAX_ENCODED_SIZE(length + 3) bytes);
+// returns the number of bytes to transmit
+inline size_t packet_encode(uint8_t type, const void* payload, size_t length, uint8_t* out) {
+    uint16_t crc = PacketCRC16::update(PacketCRC16::INIT, &type, 1);
+    crc = PacketCRC16::update(crc, (const uint8_t*)payload, length);
+    uint8_t trailer[2] = { (uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8) };
+
+    COBSEncoder encoder(out);
+    encoder.put(&type, 1);
+    encoder.put((const uint8_t*)payload, length);
+    encoder.put(trailer, 2);
+    return encoder.finish();
+}
+
+// Copy a received payload into a fixed-layout record. Records are sent
+// as raw memory, so both ends need the same layout and byte order
+// (little-endian on ESP32 and x86/ARM hosts); use packed structs.
+template<typename T>
+inline bool packet_read(const uint8_t* data, size_t length, T& record) {
+    if (length != sizeof(T)) return false;
+    memcpy(&record, data, sizeof(T));
+    return true;
+}
+
+#endif
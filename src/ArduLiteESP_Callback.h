@@ -0,0 +1,160 @@
+#ifndef ARDULITEESP_CALLBACK_H
+#define ARDULITEESP_CALLBACK_H
+
+// Fixed-size callable storage: holds a function pointer, a lambda with
+// captures or any function object inline, never on the heap. A callable
+// that does not fit is a compile error rather than an allocation.
+//
+//   Callback<void()> blink = [&led]() { led.toggle(); };
+//   Callback<void(const char*, size_t), 32> onLine = [this](const char* s, size_t n) { ... };
+//
+// Trivially copyable callables (function pointers, lambdas capturing
+// pointers and integers) are copied with memcpy and need no destructor;
+// anything else is copied/destroyed through a per-type manager function.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#ifndef CALLBACK_CAPACITY
+  #define CALLBACK_CAPACITY                 (4 * sizeof(void*))  // Four captured pointers/references
+#endif
+
+template<typename Signature, size_t CAPACITY = CALLBACK_CAPACITY>
+class Callback;
+
+template<typename R, typename... Args, size_t CAPACITY>
+class Callback<R(Args...), CAPACITY> {
+private:
+    enum Operation : uint8_t { COPY, MOVE, DESTROY };
+
+    alignas(alignof(max_align_t)) mutable uint8_t storage[CAPACITY];
+    R (*invoker)(void* target, Args... args);
+    void (*manager)(Operation operation, void* target, void* source);
+
+    template<typename F>
+    static R invoke(void* target, Args... args) {
+        return (*(F*)target)(std::forward<Args>(args)...);
+    }
+
+    template<typename F>
+    static void manage(Operation operation, void* target, void* source) {
+        switch (operation) {
+            case COPY:    new (target) F(*(const F*)source); break;
+            case MOVE:    new (target) F(std::move(*(F*)source)); break;
+            case DESTROY: ((F*)target)->~F(); break;
+        }
+    }
+
+    template<typename F>
+    void assign(F&& function) {
+        typedef typename std::decay<F>::type Fn;
+        static_assert(sizeof(Fn) <= CAPACITY, "Callable too large for Callback, raise CAPACITY");
+        static_assert(alignof(Fn) <= alignof(max_align_t), "Callable over-aligned for Callback");
+        static_assert(std::is_copy_constructible<Fn>::value, "Callback needs a copyable callable");
+
+        if constexpr (std::is_pointer<typename std::remove_reference<F>::type>::value) {
+            if (!function) return;  // Null function pointer stays empty
+        }
+
+        new (storage) Fn(std::forward<F>(function));
+        invoker = &invoke<Fn>;
+        if constexpr (std::is_trivially_copyable<Fn>::value && std::is_trivially_destructible<Fn>::value) {
+            manager = nullptr;
+        } else {
+            manager = &manage<Fn>;
+        }
+    }
+
+    void copyFrom(const Callback& other) {
+        if (other.manager) other.manager(COPY, storage, other.storage);
+        else memcpy(storage, other.storage, CAPACITY);
+        invoker = other.invoker;
+        manager = other.manager;
+    }
+
+    void moveFrom(Callback& other) {
+        if (other.manager) other.manager(MOVE, storage, other.storage);
+        else memcpy(storage, other.storage, CAPACITY);
+        invoker = other.invoker;
+        manager = other.manager;
+        other.reset();
+    }
+
+public:
+    Callback() : storage(), invoker(nullptr), manager(nullptr) {}
+
+    Callback(std::nullptr_t) : Callback() {}
+
+    template<typename F, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<F>::type, Callback>::value>::type>
+    Callback(F&& function) : Callback() {
+        assign(std::forward<F>(function));
+    }
+
+    Callback(const Callback& other) : Callback() {
+        copyFrom(other);
+    }
+
+    Callback(Callback&& other) : Callback() {
+        moveFrom(other);
+    }
+
+    ~Callback() {
+        reset();
+    }
+
+    Callback& operator=(const Callback& other) {
+        if (this != &other) {
+            reset();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    Callback& operator=(Callback&& other) {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    Callback& operator=(std::nullptr_t) {
+        reset();
+        return *this;
+    }
+
+    template<typename F, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<F>::type, Callback>::value>::type>
+    Callback& operator=(F&& function) {
+        reset();
+        assign(std::forward<F>(function));
+        return *this;
+    }
+
+    void reset() {
+        if (manager) manager(DESTROY, storage, nullptr);
+        invoker = nullptr;
+        manager = nullptr;
+    }
+
+    explicit operator bool() const {
+        return invoker != nullptr;
+    }
+
+    // Calling an empty Callback is undefined; check it first
+    R operator()(Args... args) const {
+        return invoker(storage, std::forward<Args>(args)...);
+    }
+
+    static constexpr size_t capacity() {
+        return CAPACITY;
+    }
+};
+
+#endif
@@ -30,6 +30,8 @@ extern "C" {
 }
 #endif
 
+#include <initializer_list>
+
 // ============================================================================
 // Pin Modes
 // ============================================================================
@@ -43,6 +45,10 @@ extern "C" {
 #define INPUT_PULLUP    IN_PULLUP
 #define INPUT_PULLDOWN  IN_PULLDOWN
 
+#ifndef DIGITAL_PORT_MAX_PINS
+  #define DIGITAL_PORT_MAX_PINS   8     // Bits of a DigitalPort value; extra pins are dropped
+#endif
+
 // ============================================================================
 // Timing
 // ============================================================================
@@ -72,6 +78,41 @@ inline int32_t random(int32_t min, int32_t max) {
 }
 #endif
 
+// One reading of the monotonic clock. Take it once per loop pass and pass
+// it to every update() instead of each object reading the clock again:
+//
+//   Instant t = Instant::now();
+//   led1.update(t);
+//   led2.update(t);
+//   if (button.pressed(t)) ...
+//
+// micros() is 64-bit and never wraps; millis() is the usual 32-bit value,
+// divided out once when the snapshot is taken.
+class Instant {
+public:
+    Instant() : us(0), ms(0) {}
+
+    explicit Instant(int64_t time_us)
+        : us(time_us),
+          ms((uint32_t)(time_us / 1000)) {}
+
+    int64_t micros() const {
+        return us;
+    }
+
+    uint32_t millis() const {
+        return ms;
+    }
+
+    static Instant now() {
+        return Instant(esp_timer_get_time());
+    }
+
+private:
+    int64_t  us;
+    uint32_t ms;
+};
+
 // ============================================================================
 // Digital Pin
 // ============================================================================
@@ -81,7 +122,13 @@ public:
         : pin(p),
           mask32(1UL << (p % 32)) {
 
-        if (p > 39) return;
+        configure(p, mode);
+    }
+
+    static void configure(uint8_t pin, uint8_t mode) {
+        if (pin > 39) return;
+
+        uint32_t mask32 = 1UL << (pin % 32);
 
         if (mode == OUT) {
             gpio_pullup_dis((gpio_num_t)pin);
@@ -141,6 +188,139 @@ private:
     uint32_t mask32;
 };
 
+// ============================================================================
+// Digital Port (several pins written in one register access per bank)
+// ============================================================================
+// Bit i of a value is the i-th pin of the list:
+//
+//   DigitalPort bus{12, 13, 14, 15, 16, 17, 18, 19};
+//   bus.write(0xA5);          // All 8 pins: one W1TS + one W1TC
+//   bus.set(0x01);            // Pin 12 high, others untouched
+//
+// Values map to register masks through 16-entry tables, one per 4 bits,
+// built once in the constructor. W1TS/W1TC writes leave other pins alone,
+// so ports and single Digital pins may share a bank across tasks.
+//
+// Pins past DIGITAL_PORT_MAX_PINS are not driven: getPinCount() is then
+// smaller than the list. A pin array is checked at compile time instead.
+class DigitalPort {
+public:
+    DigitalPort(std::initializer_list<uint8_t> pin_list, uint8_t mode = OUT)
+        : DigitalPort(pin_list.begin(),
+                      (uint8_t)(pin_list.size() < DIGITAL_PORT_MAX_PINS ? pin_list.size() : DIGITAL_PORT_MAX_PINS),
+                      mode) {}
+
+    template<size_t N>
+    explicit DigitalPort(const uint8_t (&pin_list)[N], uint8_t mode = OUT)
+        : DigitalPort(pin_list, (uint8_t)N, mode) {
+        static_assert(N <= DIGITAL_PORT_MAX_PINS, "Too many pins for DigitalPort, raise DIGITAL_PORT_MAX_PINS");
+    }
+
+    DigitalPort(const uint8_t* pin_list, uint8_t count, uint8_t mode = OUT)
+        : pin_count(0) {
+
+        if (count > DIGITAL_PORT_MAX_PINS) count = DIGITAL_PORT_MAX_PINS;
+
+        for (uint8_t i = 0; i < count; i++) {
+            pins[pin_count++] = pin_list[i];
+            Digital::configure(pin_list[i], mode);
+        }
+
+        build_table();
+        used = to_masks(UINT32_MAX);
+    }
+
+    // Drive every pin of the port from `value`
+    inline void write(uint32_t value) {
+        Masks high = to_masks(value);
+
+        if (used.bank0) {
+            GPIO.out_w1ts = high.bank0;
+            GPIO.out_w1tc = used.bank0 & ~high.bank0;
+        }
+        if (used.bank1) {
+            GPIO.out1_w1ts.val = high.bank1;
+            GPIO.out1_w1tc.val = used.bank1 & ~high.bank1;
+        }
+    }
+
+    // Drive the pins whose bits are set in `mask` high
+    inline void set(uint32_t mask) {
+        Masks m = to_masks(mask);
+        if (m.bank0) GPIO.out_w1ts = m.bank0;
+        if (m.bank1) GPIO.out1_w1ts.val = m.bank1;
+    }
+
+    // Drive the pins whose bits are set in `mask` low
+    inline void clear(uint32_t mask) {
+        Masks m = to_masks(mask);
+        if (m.bank0) GPIO.out_w1tc = m.bank0;
+        if (m.bank1) GPIO.out1_w1tc.val = m.bank1;
+    }
+
+    uint32_t read() const {
+        uint32_t in0 = used.bank0 ? GPIO.in : 0;
+        uint32_t in1 = used.bank1 ? GPIO.in1.val : 0;
+        uint32_t value = 0;
+
+        for (uint8_t i = 0; i < pin_count; i++) {
+            uint8_t p = pins[i];
+            if (p > 39) continue;
+
+            uint32_t level = p < 32 ? (in0 >> p) & 1U : (in1 >> (p - 32)) & 1U;
+            value |= level << i;
+        }
+        return value;
+    }
+
+    uint8_t getPinCount() const {
+        return pin_count;
+    }
+
+private:
+    inline static constexpr uint8_t NIBBLES = (DIGITAL_PORT_MAX_PINS + 3) / 4;
+
+    struct Masks {
+        uint32_t bank0;     // GPIO0-31
+        uint32_t bank1;     // GPIO32-39
+    };
+
+    uint8_t pins[DIGITAL_PORT_MAX_PINS];
+    uint8_t pin_count;
+    Masks   used;
+    Masks   table[NIBBLES][16];
+
+    void build_table() {
+        for (uint8_t n = 0; n < NIBBLES; n++) {
+            for (uint8_t v = 0; v < 16; v++) {
+                Masks m = {0, 0};
+
+                for (uint8_t b = 0; b < 4; b++) {
+                    uint8_t bit = n * 4 + b;
+                    if (!(v & (1U << b)) || bit >= pin_count) continue;
+
+                    uint8_t p = pins[bit];
+                    if (p > 39) continue;
+
+                    if (p < 32) m.bank0 |= 1UL << p;
+                    else m.bank1 |= 1UL << (p - 32);
+                }
+                table[n][v] = m;
+            }
+        }
+    }
+
+    inline Masks to_masks(uint32_t value) const {
+        Masks m = table[0][value & 0xF];
+        for (uint8_t n = 1; n < NIBBLES; n++) {
+            value >>= 4;
+            m.bank0 |= table[n][value & 0xF].bank0;
+            m.bank1 |= table[n][value & 0xF].bank1;
+        }
+        return m;
+    }
+};
+
 // ============================================================================
 // Timer
 // ============================================================================
@@ -148,27 +328,27 @@ class Timer {
 public:
     Timer() : start_time(0), running(false) {}
 
-    void start() {
-        start_time = millis();
+    void start(const Instant& t = Instant::now()) {
+        start_time = t.millis();
         running = true;
     }
 
-    void reset() {
-        start();
+    void reset(const Instant& t = Instant::now()) {
+        start(t);
     }
 
     void stop() {
         running = false;
     }
 
-    uint32_t elapsed() const {
+    uint32_t elapsed(const Instant& t = Instant::now()) const {
         if (!running) return 0;
-        return millis() - start_time;
+        return t.millis() - start_time;
     }
 
-    bool timeout(uint32_t ms) {
-        if (elapsed() >= ms) {
-            reset();
+    bool timeout(uint32_t ms, const Instant& t = Instant::now()) {
+        if (elapsed(t) >= ms) {
+            reset(t);
             return true;
         }
         return false;
@@ -183,6 +363,118 @@ private:
     bool running;
 };
 
+// ============================================================================
+// MicroTimer (64-bit microseconds, never wraps)
+// ============================================================================
+class MicroTimer {
+public:
+    MicroTimer() : start_us(0), running(false) {}
+
+    void start(const Instant& t = Instant::now()) {
+        start_us = t.micros();
+        running = true;
+    }
+
+    void reset(const Instant& t = Instant::now()) {
+        start(t);
+    }
+
+    void stop() {
+        running = false;
+    }
+
+    uint64_t elapsed(const Instant& t = Instant::now()) const {
+        if (!running) return 0;
+        return (uint64_t)(t.micros() - start_us);
+    }
+
+    uint64_t elapsedMs(const Instant& t = Instant::now()) const {
+        return elapsed(t) / 1000;
+    }
+
+    // True once per `interval_us`. Advances by whole intervals so a
+    // periodic check does not drift; after a long stall it resyncs
+    // instead of firing back to back.
+    bool timeout(uint64_t interval_us, const Instant& t = Instant::now()) {
+        if (!running || elapsed(t) < interval_us) return false;
+        start_us += interval_us;
+        if (elapsed(t) >= interval_us) start_us = t.micros();
+        return true;
+    }
+
+    bool isRunning() const {
+        return running;
+    }
+
+private:
+    int64_t start_us;
+    bool running;
+};
+
+// ============================================================================
+// Deadline (absolute 64-bit microsecond expiry)
+// ============================================================================
+class Deadline {
+public:
+    Deadline() : expires_us(NEVER) {}
+
+    explicit Deadline(uint64_t timeout_us, const Instant& t = Instant::now()) {
+        set(timeout_us, t);
+    }
+
+    void set(uint64_t timeout_us, const Instant& t = Instant::now()) {
+        uint64_t room = (uint64_t)(NEVER - t.micros());
+        expires_us = timeout_us < room ? t.micros() + (int64_t)timeout_us : NEVER;
+    }
+
+    void setMs(uint32_t timeout_ms, const Instant& t = Instant::now()) {
+        set((uint64_t)timeout_ms * 1000, t);
+    }
+
+    // Push the expiry back, e.g. on every received byte
+    void extend(uint64_t us) {
+        if (expires_us == NEVER) return;
+        uint64_t room = (uint64_t)(NEVER - expires_us);
+        expires_us = us < room ? expires_us + (int64_t)us : NEVER;
+    }
+
+    void clear() {
+        expires_us = NEVER;
+    }
+
+    bool isSet() const {
+        return expires_us != NEVER;
+    }
+
+    bool expired(const Instant& t = Instant::now()) const {
+        return t.micros() >= expires_us;
+    }
+
+    uint64_t remaining(const Instant& t = Instant::now()) const {
+        if (expired(t)) return 0;
+        return (uint64_t)(expires_us - t.micros());
+    }
+
+    // Rounded up, so waiting this long always reaches the deadline
+    uint32_t remainingMs(const Instant& t = Instant::now()) const {
+        uint64_t ms = (remaining(t) + 999) / 1000;
+        return ms < UINT32_MAX ? (uint32_t)ms : UINT32_MAX;
+    }
+
+    // Timeout for a blocking FreeRTOS call; portMAX_DELAY when not set
+    TickType_t remainingTicks(const Instant& t = Instant::now()) const {
+        if (!isSet()) return portMAX_DELAY;
+        uint64_t tick_us = 1000000ULL / configTICK_RATE_HZ;
+        uint64_t ticks = (remaining(t) + tick_us - 1) / tick_us;
+        return ticks < portMAX_DELAY ? (TickType_t)ticks : portMAX_DELAY - 1;
+    }
+
+private:
+    inline static constexpr int64_t NEVER = INT64_MAX;
+
+    int64_t expires_us;
+};
+
 // ============================================================================
 // Analog (ADC1 Only - ESP32)
 // ============================================================================
@@ -45,19 +45,19 @@ public:
         state ? on() : off();
     }
 
-    void blink(uint32_t interval_ms) {
+    void blink(uint32_t interval_ms, const Instant& t = Instant::now()) {
         blink_interval = interval_ms;
-        last_blink_time = millis();
+        last_blink_time = t.millis();
         blink_state = false;
     }
 
-    void update() {
+    // Pass a shared Instant::now() snapshot when updating many objects per pass
+    void update(const Instant& t = Instant::now()) {
         if (blink_interval > 0) {
-            uint32_t now = millis();
-            if (now - last_blink_time >= blink_interval) {
+            if (t.millis() - last_blink_time >= blink_interval) {
                 toggle();
                 blink_state = !blink_state;
-                last_blink_time = now;
+                last_blink_time = t.millis();
             }
         }
     }
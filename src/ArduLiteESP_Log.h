@@ -0,0 +1,243 @@
+#ifndef ARDULITEESP_LOG_H
+#define ARDULITEESP_LOG_H
+
+// Deferred binary logging. A call site stores the address of its format
+// string plus raw 32-bit arguments in a lock-free MPSCRing; a low-priority
+// task drains the ring as COBS packets (ArduLiteESP_COBS.h) and
+// extras/log_decode.py formats them on the host using the firmware ELF.
+//
+//   #include <ArduLiteESP_Log.h>
+//   logger.begin();                       // Drain task on `uart`
+//   LOG_I("adc=%d t=%f", value, temp);    // ~ one ring slot, no formatting
+//
+// Levels compile out completely, arguments included. LOG_LEVEL is read
+// where each LOG_x() is expanded, so a module can change it locally:
+//   #undef LOG_LEVEL
+//   #define LOG_LEVEL LOG_LEVEL_WARN
+//
+// With DEBUG_DEFERRED defined next to DEBUG, debug()/debugLine() record
+// their value into the same ring instead of formatting on the caller's
+// task.
+
+#include "ArduLiteESP_UART.h"
+#include "ArduLiteESP_COBS.h"
+#include "ArduLiteESP_Ring.h"
+#include <type_traits>
+
+// Log Levels
+#define LOG_LEVEL_NONE                      0
+#define LOG_LEVEL_ERROR                     1
+#define LOG_LEVEL_WARN                      2
+#define LOG_LEVEL_INFO                      3
+#define LOG_LEVEL_DEBUG                     4
+
+#ifndef LOG_LEVEL
+  #define LOG_LEVEL                         LOG_LEVEL_INFO
+#endif
+
+// Log Settings
+#ifndef LOG_RING_SIZE
+  #define LOG_RING_SIZE                     64    // Records, power of two
+#endif
+#define LOG_MAX_ARGS                        4
+#define LOG_PACKET_TYPE                     0x4C  // 'L'
+#define LOG_DRAIN_INTERVAL_MS               10
+#define LOG_DRAIN_TASK_STACK                2048
+#define LOG_DRAIN_TASK_PRIO                 1
+
+// Record ids below 0x100 tag debug() values; every other id is the
+// address of a format string
+#define LOG_TAG_DROPPED                     0x01  // args[0] = records lost
+#define LOG_TAG_INT                         0x02
+#define LOG_TAG_UINT                        0x03
+#define LOG_TAG_FLOAT                       0x04
+#define LOG_TAG_BOOL                        0x05
+#define LOG_TAG_CHAR                        0x06
+#define LOG_TAG_STRING                      0x07  // Up to 16 chars packed in args
+
+#define LOG_PARAM_NEWLINE                   0x80  // debugLine()
+
+// Wire payload: id u32 | time_us u32 | level u8 | param u8 | argc u8 | args u32[argc]
+#define LOG_RECORD_HEADER_SIZE              11
+
+#define LOG_AT(level, format, ...) \
+    do { \
+        if ((level) <= LOG_LEVEL) logger.record((level), "" format, ##__VA_ARGS__); \
+    } while (0)
+
+#define LOG_E(format, ...)  LOG_AT(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#define LOG_W(format, ...)  LOG_AT(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define LOG_I(format, ...)  LOG_AT(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LOG_D(format, ...)  LOG_AT(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+
+class LogRing {
+private:
+    struct Record {
+        uint32_t id;
+        uint32_t time_us;
+        uint8_t level;
+        uint8_t param;
+        uint8_t argc;
+        uint32_t args[LOG_MAX_ARGS];
+    };
+
+    MPSCRing<Record, LOG_RING_SIZE> ring;
+    std::atomic<uint32_t> dropped;
+    uint32_t dropped_reported;
+    UART* port;
+    TaskHandle_t task_handle;
+
+    template<typename T>
+    static uint32_t toWord(T value) {
+        if constexpr (std::is_floating_point<T>::value) {
+            float f = (float)value;
+            uint32_t word;
+            memcpy(&word, &f, sizeof(word));
+            return word;
+        } else if constexpr (std::is_pointer<T>::value) {
+            return (uint32_t)(uintptr_t)value;
+        } else {
+            return (uint32_t)value;
+        }
+    }
+
+    bool push(uint32_t id, uint8_t level, uint8_t param, uint8_t argc, const uint32_t* args) {
+        Record record;
+        record.id = id;
+        record.time_us = (uint32_t)esp_timer_get_time();
+        record.level = level;
+        record.param = param;
+        record.argc = argc;
+        memcpy(record.args, args, argc * sizeof(uint32_t));
+
+        if (ring.push(record)) return true;
+        dropped.fetch_add(1, std::memory_order_relaxed);  // Full
+        return false;
+    }
+
+    static size_t serialize(uint8_t* out, uint32_t id, uint32_t time_us, uint8_t level,
+                            uint8_t param, uint8_t argc, const uint32_t* args) {
+        memcpy(&out[0], &id, 4);
+        memcpy(&out[4], &time_us, 4);
+        out[8] = level;
+        out[9] = param;
+        out[10] = argc;
+        memcpy(&out[LOG_RECORD_HEADER_SIZE], args, argc * sizeof(uint32_t));
+        return LOG_RECORD_HEADER_SIZE + argc * sizeof(uint32_t);
+    }
+
+    static void drain_task_entry(void* param) {
+        LogRing* self = (LogRing*)param;
+        while (true) {
+            self->drain();
+            vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
+        }
+    }
+
+public:
+    LogRing() : dropped(0), dropped_reported(0), port(nullptr), task_handle(nullptr) {}
+
+    // Start the drain task. `port` must already be started with begin().
+    bool begin(UART& uart_port = uart, UBaseType_t priority = LOG_DRAIN_TASK_PRIO) {
+        port = &uart_port;
+        if (task_handle) return true;
+        return xTaskCreate(drain_task_entry, "log_drain", LOG_DRAIN_TASK_STACK,
+                           this, priority, &task_handle) == pdPASS;
+    }
+
+    template<typename... Args>
+    bool record(uint8_t level, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+        const uint32_t words[] = { 0, toWord(args)... };
+        return push((uint32_t)(uintptr_t)format, level, 0, sizeof...(Args), &words[1]);
+    }
+
+    // Tagged value for debug()/debugLine()
+    template<typename T>
+    bool value(T data, uint8_t param) {
+        if constexpr (std::is_same<typename std::decay<T>::type, char*>::value) {
+            return value((const char*)data, param);
+        } else {
+            uint32_t word = toWord(data);
+            uint32_t tag;
+            if constexpr (std::is_same<T, bool>::value) tag = LOG_TAG_BOOL;
+            else if constexpr (std::is_same<T, char>::value) tag = LOG_TAG_CHAR;
+            else if constexpr (std::is_floating_point<T>::value) tag = LOG_TAG_FLOAT;
+            else if constexpr (std::is_signed<T>::value) tag = LOG_TAG_INT;
+            else tag = LOG_TAG_UINT;
+            return push(tag, LOG_LEVEL_DEBUG, param, 1, &word);
+        }
+    }
+
+    // Strings are copied (not referenced), at most 16 characters
+    bool value(const char* data, uint8_t param) {
+        uint32_t words[LOG_MAX_ARGS] = {};
+        size_t length = strnlen(data, sizeof(words));
+        memcpy(words, data, length);
+        return push(LOG_TAG_STRING, LOG_LEVEL_DEBUG, param,
+                    (uint8_t)((length + 3) / 4), words);
+    }
+
+    // Send everything recorded so far; called by the drain task
+    void drain() {
+        if (!port) return;
+
+        uint8_t batch[UART::SEND_BUF_SIZE * 2];
+        uint8_t payload[LOG_RECORD_HEADER_SIZE + LOG_MAX_ARGS * 4];
+        const size_t frame_max = COBS_MAX_ENCODED_SIZE(sizeof(payload) + PACKET_OVERHEAD);
+        size_t fill = 0;
+
+        uint32_t lost = dropped.load(std::memory_order_relaxed);
+        if (lost != dropped_reported) {
+            uint32_t count = lost - dropped_reported;
+            dropped_reported = lost;
+            size_t length = serialize(payload, LOG_TAG_DROPPED, (uint32_t)esp_timer_get_time(),
+                                      LOG_LEVEL_WARN, 0, 1, &count);
+            fill += packet_encode(LOG_PACKET_TYPE, payload, length, &batch[fill]);
+        }
+
+        while (true) {
+            if (fill + frame_max > sizeof(batch)) {
+                port->write(batch, fill);
+                fill = 0;
+            }
+            Record record;
+            if (!ring.pop(record)) break;
+            size_t length = serialize(payload, record.id, record.time_us, record.level,
+                                      record.param, record.argc, record.args);
+            fill += packet_encode(LOG_PACKET_TYPE, payload, length, &batch[fill]);
+        }
+
+        if (fill > 0) port->write(batch, fill);
+    }
+
+    uint32_t getDroppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
+
+LogRing logger;
+
+#if defined(DEBUG) && defined(DEBUG_DEFERRED)
+    template<typename T>
+    inline void debug(T data) {
+        logger.value(data, 0);
+    }
+
+    template<typename T>
+    inline void debug(T data, uint8_t param) {
+        logger.value(data, param);
+    }
+
+    template<typename T>
+    inline void debugLine(T data) {
+        logger.value(data, LOG_PARAM_NEWLINE);
+    }
+
+    template<typename T>
+    inline void debugLine(T data, uint8_t param) {
+        logger.value(data, param | LOG_PARAM_NEWLINE);
+    }
+#endif
+
+#endif
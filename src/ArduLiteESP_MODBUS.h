@@ -12,6 +12,22 @@
 #define MODBUS_FC_WRITE_SINGLE_REGISTER     0x06
 #define MODBUS_FC_WRITE_MULTIPLE_COILS      0x0F
 #define MODBUS_FC_WRITE_MULTIPLE_REGISTERS  0x10
+#define MODBUS_FC_DIAGNOSTICS               0x08
+#define MODBUS_FC_MASK_WRITE_REGISTER       0x16
+#define MODBUS_FC_READ_WRITE_REGISTERS      0x17
+
+// Diagnostics (FC 0x08) Sub-functions
+#define MODBUS_DIAG_RETURN_QUERY_DATA       0x00
+#define MODBUS_DIAG_RESTART_COMM            0x01
+#define MODBUS_DIAG_CLEAR_COUNTERS          0x0A
+#define MODBUS_DIAG_BUS_MESSAGE_COUNT       0x0B
+#define MODBUS_DIAG_BUS_CRC_ERROR_COUNT     0x0C
+#define MODBUS_DIAG_EXCEPTION_COUNT         0x0D
+#define MODBUS_DIAG_SLAVE_MESSAGE_COUNT     0x0E
+#define MODBUS_DIAG_NO_RESPONSE_COUNT       0x0F
+#define MODBUS_DIAG_SLAVE_NAK_COUNT         0x10
+#define MODBUS_DIAG_SLAVE_BUSY_COUNT        0x11
+#define MODBUS_DIAG_CHAR_OVERRUN_COUNT      0x12
 
 // Modbus Exception Codes
 #define MODBUS_EX_ILLEGAL_FUNCTION          0x01
@@ -23,21 +39,81 @@
 #define MODBUS_MAX_BUFFER                   256
 #define MODBUS_DEFAULT_TIMEOUT              1000  // ms
 #define MODBUS_FRAME_DELAY                  4     // ms (3.5 character times at 9600 baud)
+#define MODBUS_UNIT_ANY                     0xFF  // Modbus TCP: "this server"
 
-class ModbusRTU {
-protected:
-    UART* uart_port;
-    uint8_t device_address;
-    uint32_t timeout_ms;
-    
-    uint8_t tx_buffer[MODBUS_MAX_BUFFER];
-    uint8_t rx_buffer[MODBUS_MAX_BUFFER];
-    uint16_t rx_length;
-    uint32_t last_receive_time;
-    
-    // CRC16 calculation for Modbus
-    uint16_t calculateCRC16(uint8_t* data, uint16_t length) {
-        uint16_t crc = 0xFFFF;
+// ==================== MODBUS CRC16 ====================
+// Reflected CRC-16/MODBUS (poly 0xA001, init 0xFFFF). Lookup tables are
+// generated at compile time and live in flash.
+struct ModbusCRC16Tables {
+    uint16_t t[4][256];
+
+    constexpr ModbusCRC16Tables() : t() {
+        for (uint16_t i = 0; i < 256; i++) {
+            uint16_t crc = i;
+            for (uint8_t j = 0; j < 8; j++) {
+                crc = (crc & 0x0001) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+            }
+            t[0][i] = crc;
+        }
+        for (uint8_t k = 1; k < 4; k++) {
+            for (uint16_t i = 0; i < 256; i++) {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+class ModbusCRC16 {
+private:
+    inline static constexpr ModbusCRC16Tables TABLES{};
+
+    uint16_t crc;
+
+public:
+    inline static constexpr uint16_t INIT = 0xFFFF;
+
+    ModbusCRC16() : crc(INIT) {}
+
+    void reset() {
+        crc = INIT;
+    }
+
+    // Feed one byte as it arrives
+    inline void update(uint8_t data) {
+        crc = (crc >> 8) ^ TABLES.t[0][(crc ^ data) & 0xFF];
+    }
+
+    void update(const uint8_t* data, uint16_t length) {
+        crc = compute(data, length, crc);
+    }
+
+    uint16_t value() const {
+        return crc;
+    }
+
+    // Bytewise table lookup (512 bytes of table)
+    static uint16_t compute(const uint8_t* data, uint16_t length, uint16_t crc = INIT) {
+        for (uint16_t i = 0; i < length; i++) {
+            crc = (crc >> 8) ^ TABLES.t[0][(crc ^ data[i]) & 0xFF];
+        }
+        return crc;
+    }
+
+    // Slicing-by-4: four bytes per step (2 KB of table)
+    static uint16_t computeSlice4(const uint8_t* data, uint16_t length, uint16_t crc = INIT) {
+        while (length >= 4) {
+            uint8_t b0 = (uint8_t)(crc ^ data[0]);
+            uint8_t b1 = (uint8_t)((crc >> 8) ^ data[1]);
+            crc = TABLES.t[3][b0] ^ TABLES.t[2][b1] ^
+                  TABLES.t[1][data[2]] ^ TABLES.t[0][data[3]];
+            data += 4;
+            length -= 4;
+        }
+        return compute(data, length, crc);
+    }
+
+    // Reference bit-by-bit implementation
+    static uint16_t computeBitwise(const uint8_t* data, uint16_t length, uint16_t crc = INIT) {
         for (uint16_t i = 0; i < length; i++) {
             crc ^= (uint16_t)data[i];
             for (uint8_t j = 0; j < 8; j++) {
@@ -51,13 +127,45 @@ protected:
         }
         return crc;
     }
+};
+
+// The UART may be nullptr for an object that only speaks another
+// transport (ModbusTCPClient, or a slave behind ModbusTCPServer). The RTU
+// calls then do nothing: begin() and process() return at once,
+// enableRS485() returns false and blocking requests fail.
+class ModbusRTU {
+protected:
+    UART* uart_port;
+    uint8_t device_address;
+    uint32_t timeout_ms;
+    
+    uint8_t tx_buffer[MODBUS_MAX_BUFFER];
+    uint8_t rx_buffer[MODBUS_MAX_BUFFER];
+    uint16_t rx_length;
+    uint32_t last_receive_time;
+    
+    uint32_t char_time_us;
+    uint32_t t15_us;
+    uint32_t t35_us;
+    int64_t bus_idle_since_us;
+    int64_t rx_last_byte_us;
+    bool rs485_enabled;
+    bool tx_nowait;      // sendFrame leaves an RS-485 drain to busReady()
+    bool tx_draining;    // RS-485 frame still shifting out
+    
+    // CRC16 calculation for Modbus
+    uint16_t calculateCRC16(const uint8_t* data, uint16_t length) {
+#ifdef MODBUS_CRC_SLICE_BY_4
+        return ModbusCRC16::computeSlice4(data, length);
+#else
+        return ModbusCRC16::compute(data, length);
+#endif
+    }
     
-    // Check CRC16
-    bool checkCRC16(uint8_t* data, uint16_t length) {
+    // Check CRC16 (a frame with its CRC appended leaves a zero residue)
+    bool checkCRC16(const uint8_t* data, uint16_t length) {
         if (length < 3) return false;
-        uint16_t received_crc = (uint16_t)data[length - 1] << 8 | data[length - 2];
-        uint16_t calculated_crc = calculateCRC16(data, length - 2);
-        return (received_crc == calculated_crc);
+        return calculateCRC16(data, length) == 0;
     }
     
     // Add CRC16 to buffer
@@ -67,55 +175,251 @@ protected:
         data[length + 1] = (crc >> 8) & 0xFF;
     }
     
-    // Send frame
+    // Send frame. The whole frame goes to the driver in one write, after
+    // the bus has been idle for at least t3.5 since the previous frame.
     void sendFrame(uint8_t* frame, uint16_t length) {
+        if (!uart_port) return;
+        if (char_time_us == 0) updateTiming();
+        
         uart_port->flush();
-        delay(MODBUS_FRAME_DELAY);
+        waitBusIdle();
+        uart_port->write(frame, length);
+        
+        if (rs485_enabled && tx_nowait) {
+            // busReady() polls for the end of transmission
+            tx_draining = true;
+        } else if (rs485_enabled) {
+            // Exact turnaround: DE is released once the last bit is out
+            uart_port->waitTxDone(timeout_ms);
+            bus_idle_since_us = esp_timer_get_time();
+        } else {
+            bus_idle_since_us = esp_timer_get_time() + (int64_t)length * char_time_us;
+        }
+    }
+    
+    // Block until the bus has been idle for t3.5. Whole ticks are slept
+    // so other tasks run meanwhile; only the sub-tick remainder is
+    // busy-waited.
+    void waitBusIdle() {
+        const int64_t tick_us = 1000000 / configTICK_RATE_HZ;
+        
+        if (tx_draining) {
+            uart_port->waitTxDone(timeout_ms);
+            tx_draining = false;
+            bus_idle_since_us = esp_timer_get_time();
+        }
         
-        for (uint16_t i = 0; i < length; i++) {
-            uart_port->send(frame[i]);
+        while (true) {
+            int64_t remaining_us = (int64_t)t35_us - (esp_timer_get_time() - bus_idle_since_us);
+            if (remaining_us <= 0) return;
+            if (remaining_us < tick_us) {
+                ets_delay_us((uint32_t)remaining_us);
+                return;
+            }
+            vTaskDelay((TickType_t)(remaining_us / tick_us));
+        }
+    }
+    
+    // Non-blocking counterpart of waitBusIdle(): true once any RS-485
+    // transmission has drained and the bus has been idle for t3.5
+    virtual bool busReady() {
+        if (char_time_us == 0) updateTiming();
+        
+        if (tx_draining) {
+            if (!uart_port->waitTxDone(0)) return false;
+            tx_draining = false;
+            bus_idle_since_us = esp_timer_get_time();
+        }
+        return esp_timer_get_time() - bus_idle_since_us >= (int64_t)t35_us;
+    }
+    
+    // Inter-character (t1.5) and inter-frame (t3.5) silence in microseconds
+    void updateTiming() {
+        if (!uart_port) return;
+        
+        uint32_t baud = uart_port->getBaudRate();
+        if (baud == 0) return;
+
+        // 11 bits per character (start + 8 data + parity/stop + stop)
+        char_time_us = (11UL * 1000000UL + baud - 1) / baud;
+
+        // Above 19200 baud the spec fixes the intervals
+        if (baud > 19200) {
+            t15_us = 750;
+            t35_us = 1750;
+        } else {
+            t15_us = (char_time_us * 3) / 2;
+            t35_us = (char_time_us * 7) / 2;
+        }
+
+        // Hardware RX timeout is counted in whole character times
+        uint32_t symbols = (t35_us + char_time_us - 1) / char_time_us;
+        if (symbols < 1) symbols = 1;
+        if (symbols > 126) symbols = 126;
+        uart_port->setRxTimeout((uint8_t)symbols);
+    }
+    
+    // Feed one driver event into rx_buffer. Returns true at end of frame,
+    // which the driver reports as a UART_DATA event with timeout_flag set
+    // once the line has been silent for t3.5.
+    bool handleEvent(const uart_event_t& event) {
+        if (event.type == UART_DATA) {
+            readPending();
+            
+            if (event.timeout_flag && rx_length > 0) return true;
+            if (rx_length >= MODBUS_MAX_BUFFER) return true;
+        } else if (event.type == UART_FIFO_OVF || event.type == UART_BUFFER_FULL) {
+            // Frame is corrupt, drop it
+            uart_port->flush();
+            rx_length = 0;
         }
+        return false;
     }
     
-    // Receive frame
+    void frameReceived() {
+        last_receive_time = millis();
+        bus_idle_since_us = esp_timer_get_time();
+    }
+    
+    // Receive frame (blocking). Needs the driver event queue, i.e. the
+    // port started with begin() and no line callback, line queue or
+    // receive handler; an RX task on the same port would take the bytes
+    // first. Without the queue it falls back to blocking driver reads.
     uint16_t receiveFrame(uint32_t timeout) {
+        if (char_time_us == 0) updateTiming();
+        
         rx_length = 0;
+        if (!uart_port) return 0;
+        if (!uart_port->canWaitEvent()) return receiveFrameRead(timeout);
+        
         uint32_t start_time = millis();
-        uint32_t last_char_time = millis();
-        bool receiving = false;
-        
-        while (millis() - start_time < timeout) {
-            if (uart_port->available()) {
-                int data = uart_port->read();
-                if (data >= 0) {
-                    if (!receiving) {
-                        receiving = true;
-                        rx_length = 0;
-                    }
-                    
-                    if (rx_length < MODBUS_MAX_BUFFER) {
-                        rx_buffer[rx_length++] = (uint8_t)data;
-                        last_char_time = millis();
-                    }
-                }
+        uint32_t gap_ms = (2 * t35_us + 999) / 1000;
+        uart_event_t event;
+        
+        while (true) {
+            uint32_t wait_ms;
+            if (rx_length > 0) {
+                wait_ms = gap_ms;
+            } else {
+                uint32_t elapsed = millis() - start_time;
+                if (elapsed >= timeout) break;
+                wait_ms = timeout - elapsed;
             }
             
-            // Check for end of frame (3.5 character times of silence)
-            if (receiving && (millis() - last_char_time > MODBUS_FRAME_DELAY)) {
-                break;
+            if (!uart_port->waitEvent(event, wait_ms)) {
+                if (rx_length > 0) break;  // Timeout event lost, silence seen
+                continue;
             }
             
-            delay(1);
+            if (handleEvent(event)) break;
         }
         
+        frameReceived();
         return rx_length;
     }
+    
+    // receiveFrame() without driver events: block in the read itself and
+    // end the frame after 2 * t3.5 of silence, at least two ticks so a
+    // coarse tick cannot cut it short
+    uint16_t receiveFrameRead(uint32_t timeout) {
+        uint32_t start_time = millis();
+        uint32_t gap_ms = (2 * t35_us + 999) / 1000;
+        if (gap_ms < 2 * portTICK_PERIOD_MS) gap_ms = 2 * portTICK_PERIOD_MS;
+        
+        while (rx_length < MODBUS_MAX_BUFFER) {
+            uint32_t wait_ms;
+            if (rx_length > 0) {
+                wait_ms = gap_ms;
+            } else {
+                uint32_t elapsed = millis() - start_time;
+                if (elapsed >= timeout) break;
+                wait_ms = timeout - elapsed;
+            }
+            
+            int len = uart_port->read((char*)rx_buffer + rx_length, 1, wait_ms);
+            if (len < 0) break;                 // Driver not installed
+            if (len == 0) {
+                if (rx_length > 0) break;       // Silence ends the frame
+                continue;
+            }
+            rx_length += len;
+            readPending();
+        }
+        
+        frameReceived();
+        return rx_length;
+    }
+    
+    // Move whatever the driver holds into rx_buffer; returns the count
+    int readPending() {
+        int pending = uart_port->available();
+        if (pending > MODBUS_MAX_BUFFER - rx_length) {
+            pending = MODBUS_MAX_BUFFER - rx_length;
+        }
+        if (pending <= 0) return 0;
+        int len = uart_port->read((char*)rx_buffer + rx_length, pending, 0);
+        if (len <= 0) return 0;
+        rx_length += len;
+        return len;
+    }
+    
+    // Receive frame (non-blocking). Drains pending driver events and
+    // returns true once a complete frame sits in rx_buffer[0..rx_length).
+    // Without the event queue, a frame ends once no byte has been seen
+    // for t3.5.
+    bool pollFrame() {
+        if (!uart_port) return false;
+        if (!uart_port->canWaitEvent()) {
+            int64_t now_us = esp_timer_get_time();
+            if (readPending() > 0) rx_last_byte_us = now_us;
+            if (rx_length == 0) return false;
+            if (rx_length < MODBUS_MAX_BUFFER &&
+                now_us - rx_last_byte_us < (int64_t)t35_us) return false;
+            frameReceived();
+            return true;
+        }
+        
+        uart_event_t event;
+        while (uart_port->waitEvent(event, 0)) {
+            if (handleEvent(event)) {
+                frameReceived();
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // Transport hooks. tx_buffer/rx_buffer hold the unit address followed
+    // by the PDU; the transport adds and strips its own framing (CRC for
+    // RTU, the MBAP header for Modbus TCP). Lengths exclude that framing.
+    virtual void sendADU(uint16_t length) {
+        addCRC16(tx_buffer, length);
+        sendFrame(tx_buffer, length + 2);
+    }
+    
+    // Returns the ADU length, or 0 on timeout or a corrupt frame
+    virtual uint16_t receiveADU(uint32_t timeout) {
+        uint16_t length = receiveFrame(timeout);
+        if (length < 5 || !checkCRC16(rx_buffer, length)) return 0;
+        return length - 2;
+    }
+    
+    // Non-blocking receive; `length` is 0 for a corrupt frame
+    virtual bool pollADU(uint16_t& length) {
+        if (!pollFrame()) return false;
+        length = (rx_length >= 5 && checkCRC16(rx_buffer, rx_length)) ? rx_length - 2 : 0;
+        return true;
+    }
 
 public:
     ModbusRTU(UART* uart, uint8_t address = 1, uint32_t timeout = MODBUS_DEFAULT_TIMEOUT)
-        : uart_port(uart), device_address(address), timeout_ms(timeout), rx_length(0), last_receive_time(0) {
+        : uart_port(uart), device_address(address), timeout_ms(timeout), rx_length(0), last_receive_time(0),
+          char_time_us(0), t15_us(0), t35_us(0), bus_idle_since_us(0), rx_last_byte_us(0),
+          rs485_enabled(false), tx_nowait(false), tx_draining(false) {
     }
     
+    virtual ~ModbusRTU() {}
+    
     void setAddress(uint8_t address) {
         device_address = address;
     }
@@ -127,6 +431,82 @@ public:
     void setTimeout(uint32_t timeout) {
         timeout_ms = timeout;
     }
+    
+    // RS-485 half-duplex with the transceiver DE/RE driven by the UART
+    bool enableRS485(int8_t de_pin) {
+        rs485_enabled = uart_port && uart_port->setRS485(de_pin);
+        return rs485_enabled;
+    }
+    
+    // Recompute silence intervals, call after changing the UART baud rate
+    void begin() {
+        updateTiming();
+    }
+    
+    uint32_t getCharTimeUs() {
+        return char_time_us;
+    }
+    
+    uint32_t getInterCharDelayUs() {
+        return t15_us;
+    }
+    
+    uint32_t getInterFrameDelayUs() {
+        return t35_us;
+    }
+};
+
+// ==================== MODBUS ASYNC REQUEST ====================
+// Request status
+#define MODBUS_STATUS_IDLE                  0
+#define MODBUS_STATUS_QUEUED                1
+#define MODBUS_STATUS_WAITING               2
+#define MODBUS_STATUS_DONE                  3
+#define MODBUS_STATUS_TIMEOUT               4
+#define MODBUS_STATUS_EXCEPTION             5
+#define MODBUS_STATUS_FRAME_ERROR           6   // CRC, length or echo mismatch
+#define MODBUS_STATUS_INVALID               7
+
+struct ModbusRequest;
+typedef void (*ModbusRequestCallback)(ModbusRequest* request);
+
+// One transaction for ModbusMaster::submit(). The request and its data
+// buffer belong to the caller and must stay alive until it completes.
+// Reads fill `registers`/`bits`; writes send from them. For the single
+// write codes, `quantity` is ignored and the first element is written.
+// FC 0x16 takes the AND and OR masks from registers[0] and [1]. FC 0x17
+// writes `write_quantity` values from `write_registers` at
+// `write_address`, then reads `quantity` into `registers`. FC 0x08 sends
+// `address` as the sub-function and registers[0] as data, and stores the
+// data of the reply back in registers[0].
+struct ModbusRequest {
+    uint8_t slave;
+    uint8_t function;
+    uint16_t address;
+    uint16_t quantity;
+    uint16_t* registers;
+    bool* bits;
+    uint16_t write_address;
+    uint16_t write_quantity;
+    const uint16_t* write_registers;
+    ModbusRequestCallback callback;
+    void* user;
+    
+    volatile uint8_t status;
+    uint8_t exception;
+    ModbusRequest* next;
+    
+    bool busy() const {
+        return status == MODBUS_STATUS_QUEUED || status == MODBUS_STATUS_WAITING;
+    }
+    
+    bool done() const {
+        return status >= MODBUS_STATUS_DONE;
+    }
+    
+    bool ok() const {
+        return status == MODBUS_STATUS_DONE;
+    }
 };
 
 // ==================== MODBUS MASTER ====================
@@ -134,6 +514,179 @@ class ModbusMaster : public ModbusRTU {
 private:
     uint8_t last_exception;
     
+    // Async request queue (intrusive, caller-owned nodes)
+    ModbusRequest* queue_head;
+    ModbusRequest* queue_tail;
+    uint32_t request_start;
+    
+    static void packCoils(const bool* data, uint16_t quantity, uint8_t* out) {
+        memset(out, 0, (quantity + 7) / 8);
+        for (uint16_t i = 0; i < quantity; i++) {
+            if (data[i]) out[i / 8] |= (1 << (i % 8));
+        }
+    }
+    
+    static void packRegisters(const uint16_t* data, uint16_t quantity, uint8_t* out) {
+        for (uint16_t i = 0; i < quantity; i++) {
+            out[i * 2] = (data[i] >> 8) & 0xFF;
+            out[i * 2 + 1] = data[i] & 0xFF;
+        }
+    }
+    
+    uint16_t rxWord(uint16_t offset) const {
+        return ((uint16_t)rx_buffer[offset] << 8) | rx_buffer[offset + 1];
+    }
+    
+    // Reply checks on rx_buffer; `length` as returned by receiveADU()
+    bool bitsReply(uint16_t length, uint16_t quantity) const {
+        return length >= 3 && rx_buffer[2] == (quantity + 7) / 8 && length >= 3 + rx_buffer[2];
+    }
+    
+    bool registersReply(uint16_t length, uint16_t quantity) const {
+        return length >= 3 && rx_buffer[2] == quantity * 2 && length >= 3 + rx_buffer[2];
+    }
+    
+    bool echoReply(uint16_t length, uint16_t first, uint16_t second) const {
+        return length >= 6 && rxWord(2) == first && rxWord(4) == second;
+    }
+    
+    bool maskReply(uint16_t length, uint16_t addr, uint16_t and_mask, uint16_t or_mask) const {
+        return length >= 8 && echoReply(length, addr, and_mask) && rxWord(6) == or_mask;
+    }
+    
+    void unpackBits(uint16_t quantity, bool* out) const {
+        for (uint16_t i = 0; i < quantity; i++) {
+            out[i] = (rx_buffer[3 + i / 8] >> (i % 8)) & 0x01;
+        }
+    }
+    
+    void unpackRegisters(uint16_t quantity, uint16_t* out) const {
+        for (uint16_t i = 0; i < quantity; i++) {
+            out[i] = rxWord(3 + i * 2);
+        }
+    }
+    
+    static bool validRequest(const ModbusRequest& req) {
+        switch (req.function) {
+            case MODBUS_FC_READ_COILS:
+            case MODBUS_FC_READ_DISCRETE_INPUTS:
+                return req.bits && req.quantity > 0 && req.quantity <= 2000;
+            case MODBUS_FC_READ_HOLDING_REGISTERS:
+            case MODBUS_FC_READ_INPUT_REGISTERS:
+                return req.registers && req.quantity > 0 && req.quantity <= 125;
+            case MODBUS_FC_WRITE_SINGLE_COIL:
+                return req.bits != nullptr;
+            case MODBUS_FC_WRITE_SINGLE_REGISTER:
+            case MODBUS_FC_MASK_WRITE_REGISTER:
+            case MODBUS_FC_DIAGNOSTICS:
+                return req.registers != nullptr;
+            case MODBUS_FC_WRITE_MULTIPLE_COILS:
+                return req.bits && req.quantity > 0 && req.quantity <= 1968;
+            case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
+                return req.registers && req.quantity > 0 && req.quantity <= 123;
+            case MODBUS_FC_READ_WRITE_REGISTERS:
+                return req.registers && req.quantity > 0 && req.quantity <= 125 &&
+                       req.write_registers && req.write_quantity > 0 && req.write_quantity <= 121;
+            default:
+                return false;
+        }
+    }
+    
+    void startRequest(ModbusRequest& req) {
+        uint8_t payload[246];
+        
+        switch (req.function) {
+            case MODBUS_FC_WRITE_SINGLE_COIL:
+                sendRequest(req.slave, req.function, req.address, req.bits[0] ? 0xFF00 : 0x0000);
+                break;
+            case MODBUS_FC_WRITE_SINGLE_REGISTER:
+                sendRequest(req.slave, req.function, req.address, req.registers[0]);
+                break;
+            case MODBUS_FC_WRITE_MULTIPLE_COILS:
+                packCoils(req.bits, req.quantity, payload);
+                sendRequest(req.slave, req.function, req.address, req.quantity,
+                            payload, (req.quantity + 7) / 8);
+                break;
+            case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
+                packRegisters(req.registers, req.quantity, payload);
+                sendRequest(req.slave, req.function, req.address, req.quantity,
+                            payload, req.quantity * 2);
+                break;
+            case MODBUS_FC_MASK_WRITE_REGISTER:
+                sendMaskWrite(req.slave, req.address, req.registers[0], req.registers[1]);
+                break;
+            case MODBUS_FC_READ_WRITE_REGISTERS:
+                sendReadWrite(req.slave, req.address, req.quantity,
+                              req.write_address, req.write_quantity, req.write_registers);
+                break;
+            case MODBUS_FC_DIAGNOSTICS:
+                sendRequest(req.slave, req.function, req.address, req.registers[0]);
+                break;
+            default:
+                sendRequest(req.slave, req.function, req.address, req.quantity);
+                break;
+        }
+        
+        rx_length = 0;
+        request_start = millis();
+        req.status = MODBUS_STATUS_WAITING;
+    }
+    
+    // Check the frame in rx_buffer against the request and copy out data
+    uint8_t finishRequest(ModbusRequest& req, uint16_t length) {
+        if (length < 3) return MODBUS_STATUS_FRAME_ERROR;
+        if (rx_buffer[0] != req.slave) return MODBUS_STATUS_FRAME_ERROR;
+        
+        if (rx_buffer[1] == (req.function | 0x80)) {
+            req.exception = rx_buffer[2];
+            return MODBUS_STATUS_EXCEPTION;
+        }
+        if (rx_buffer[1] != req.function) return MODBUS_STATUS_FRAME_ERROR;
+        
+        switch (req.function) {
+            case MODBUS_FC_READ_COILS:
+            case MODBUS_FC_READ_DISCRETE_INPUTS:
+                if (!bitsReply(length, req.quantity)) return MODBUS_STATUS_FRAME_ERROR;
+                unpackBits(req.quantity, req.bits);
+                break;
+            case MODBUS_FC_READ_HOLDING_REGISTERS:
+            case MODBUS_FC_READ_INPUT_REGISTERS:
+            case MODBUS_FC_READ_WRITE_REGISTERS:
+                if (!registersReply(length, req.quantity)) return MODBUS_STATUS_FRAME_ERROR;
+                unpackRegisters(req.quantity, req.registers);
+                break;
+            case MODBUS_FC_WRITE_SINGLE_COIL:
+                if (!echoReply(length, req.address, req.bits[0] ? 0xFF00 : 0x0000)) return MODBUS_STATUS_FRAME_ERROR;
+                break;
+            case MODBUS_FC_WRITE_SINGLE_REGISTER:
+                if (!echoReply(length, req.address, req.registers[0])) return MODBUS_STATUS_FRAME_ERROR;
+                break;
+            case MODBUS_FC_WRITE_MULTIPLE_COILS:
+            case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
+                if (!echoReply(length, req.address, req.quantity)) return MODBUS_STATUS_FRAME_ERROR;
+                break;
+            case MODBUS_FC_MASK_WRITE_REGISTER:
+                if (!maskReply(length, req.address, req.registers[0], req.registers[1])) return MODBUS_STATUS_FRAME_ERROR;
+                break;
+            case MODBUS_FC_DIAGNOSTICS:
+                if (length < 6 || rxWord(2) != req.address) return MODBUS_STATUS_FRAME_ERROR;
+                req.registers[0] = rxWord(4);
+                break;
+            default:
+                break;
+        }
+        return MODBUS_STATUS_DONE;
+    }
+    
+    void completeRequest(uint8_t status) {
+        ModbusRequest* req = queue_head;
+        queue_head = req->next;
+        if (!queue_head) queue_tail = nullptr;
+        req->next = nullptr;
+        req->status = status;
+        if (req->callback) req->callback(req);
+    }
+    
     bool sendRequest(uint8_t slave_addr, uint8_t function_code, uint16_t start_addr, 
                      uint16_t quantity, uint8_t* data = nullptr, uint16_t data_length = 0) {
         uint16_t index = 0;
@@ -161,36 +714,133 @@ private:
             tx_buffer[index++] = quantity & 0xFF;
         }
         
-        addCRC16(tx_buffer, index);
-        index += 2;
-        
-        sendFrame(tx_buffer, index);
+        sendADU(index);
         return true;
     }
     
-    bool waitResponse() {
-        uint16_t length = receiveFrame(timeout_ms);
+    void sendMaskWrite(uint8_t slave_addr, uint16_t addr, uint16_t and_mask, uint16_t or_mask) {
+        uint16_t index = 0;
         
-        if (length < 5) {
-            return false;  // Too short
-        }
+        tx_buffer[index++] = slave_addr;
+        tx_buffer[index++] = MODBUS_FC_MASK_WRITE_REGISTER;
+        tx_buffer[index++] = (addr >> 8) & 0xFF;
+        tx_buffer[index++] = addr & 0xFF;
+        tx_buffer[index++] = (and_mask >> 8) & 0xFF;
+        tx_buffer[index++] = and_mask & 0xFF;
+        tx_buffer[index++] = (or_mask >> 8) & 0xFF;
+        tx_buffer[index++] = or_mask & 0xFF;
+        
+        sendADU(index);
+    }
+    
+    void sendReadWrite(uint8_t slave_addr, uint16_t read_addr, uint16_t read_quantity,
+                       uint16_t write_addr, uint16_t write_quantity, const uint16_t* write_data) {
+        uint16_t index = 0;
         
-        if (!checkCRC16(rx_buffer, length)) {
-            return false;  // CRC error
+        tx_buffer[index++] = slave_addr;
+        tx_buffer[index++] = MODBUS_FC_READ_WRITE_REGISTERS;
+        tx_buffer[index++] = (read_addr >> 8) & 0xFF;
+        tx_buffer[index++] = read_addr & 0xFF;
+        tx_buffer[index++] = (read_quantity >> 8) & 0xFF;
+        tx_buffer[index++] = read_quantity & 0xFF;
+        tx_buffer[index++] = (write_addr >> 8) & 0xFF;
+        tx_buffer[index++] = write_addr & 0xFF;
+        tx_buffer[index++] = (write_quantity >> 8) & 0xFF;
+        tx_buffer[index++] = write_quantity & 0xFF;
+        tx_buffer[index++] = write_quantity * 2;
+        
+        packRegisters(write_data, write_quantity, &tx_buffer[index]);
+        index += write_quantity * 2;
+        
+        sendADU(index);
+    }
+    
+    // Returns the reply length, or 0 on timeout, CRC error, exception or a
+    // reply from the wrong slave or to another function code
+    uint16_t waitResponse(uint8_t slave_addr, uint8_t function_code) {
+        uint16_t length = receiveADU(timeout_ms);
+        
+        if (length < 3) {
+            return 0;  // Timeout, too short or CRC error
         }
+        if (rx_buffer[0] != slave_addr) return 0;
         
         // Check for exception response
-        if (rx_buffer[1] & 0x80) {
+        if (rx_buffer[1] == (function_code | 0x80)) {
             last_exception = rx_buffer[2];
-            return false;
+            return 0;
         }
+        if (rx_buffer[1] != function_code) return 0;
         
-        return true;
+        return length;
     }
 
 public:
     ModbusMaster(UART* uart, uint32_t timeout = MODBUS_DEFAULT_TIMEOUT)
-        : ModbusRTU(uart, 1, timeout), last_exception(0) {
+        : ModbusRTU(uart, 1, timeout), last_exception(0),
+          queue_head(nullptr), queue_tail(nullptr), request_start(0) {
+    }
+    
+    // Queue a request without blocking. Progress is made by update();
+    // completion is reported through request.status and request.callback.
+    bool submit(ModbusRequest& request) {
+        if (request.busy()) return false;
+        
+        request.exception = 0;
+        request.next = nullptr;
+        
+        if (!validRequest(request)) {
+            request.status = MODBUS_STATUS_INVALID;
+            return false;
+        }
+        
+        request.status = MODBUS_STATUS_QUEUED;
+        if (queue_tail) queue_tail->next = &request;
+        else queue_head = &request;
+        queue_tail = &request;
+        return true;
+    }
+    
+    // Advance the async state machine without blocking. Call it often,
+    // e.g. once per loop for every master the task owns. Returns true
+    // while requests are outstanding.
+    bool update() {
+        while (queue_head) {
+            ModbusRequest& req = *queue_head;
+            
+            if (req.status == MODBUS_STATUS_QUEUED) {
+                // Still inside t3.5 (or draining): try again next call
+                if (!busReady()) return true;
+                
+                tx_nowait = true;
+                startRequest(req);
+                tx_nowait = false;
+                
+                // Broadcasts are never answered
+                if (req.slave == 0) {
+                    completeRequest(MODBUS_STATUS_DONE);
+                    continue;
+                }
+            }
+            
+            uint16_t length;
+            if (pollADU(length)) {
+                completeRequest(finishRequest(req, length));
+                continue;
+            }
+            
+            if (millis() - request_start >= timeout_ms) {
+                completeRequest(MODBUS_STATUS_TIMEOUT);
+                continue;
+            }
+            
+            return true;
+        }
+        return false;
+    }
+    
+    bool isBusy() const {
+        return queue_head != nullptr;
     }
     
     uint8_t getLastException() {
@@ -204,15 +854,10 @@ public:
         last_exception = 0;
         sendRequest(slave_addr, MODBUS_FC_READ_COILS, start_addr, quantity);
         
-        if (!waitResponse()) return false;
-        
-        uint8_t byte_count = rx_buffer[2];
-        for (uint16_t i = 0; i < quantity; i++) {
-            uint16_t byte_index = i / 8;
-            uint8_t bit_index = i % 8;
-            data[i] = (rx_buffer[3 + byte_index] >> bit_index) & 0x01;
-        }
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_READ_COILS);
+        if (!bitsReply(length, quantity)) return false;
         
+        unpackBits(quantity, data);
         return true;
     }
     
@@ -223,15 +868,10 @@ public:
         last_exception = 0;
         sendRequest(slave_addr, MODBUS_FC_READ_DISCRETE_INPUTS, start_addr, quantity);
         
-        if (!waitResponse()) return false;
-        
-        uint8_t byte_count = rx_buffer[2];
-        for (uint16_t i = 0; i < quantity; i++) {
-            uint16_t byte_index = i / 8;
-            uint8_t bit_index = i % 8;
-            data[i] = (rx_buffer[3 + byte_index] >> bit_index) & 0x01;
-        }
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_READ_DISCRETE_INPUTS);
+        if (!bitsReply(length, quantity)) return false;
         
+        unpackBits(quantity, data);
         return true;
     }
     
@@ -242,278 +882,816 @@ public:
         last_exception = 0;
         sendRequest(slave_addr, MODBUS_FC_READ_HOLDING_REGISTERS, start_addr, quantity);
         
-        if (!waitResponse()) return false;
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_READ_HOLDING_REGISTERS);
+        if (!registersReply(length, quantity)) return false;
         
-        uint8_t byte_count = rx_buffer[2];
-        for (uint16_t i = 0; i < quantity; i++) {
-            data[i] = ((uint16_t)rx_buffer[3 + i * 2] << 8) | rx_buffer[4 + i * 2];
+        unpackRegisters(quantity, data);
+        return true;
+    }
+    
+    // Read Input Registers (FC 0x04)
+    bool readInputRegisters(uint8_t slave_addr, uint16_t start_addr, uint16_t quantity, uint16_t* data) {
+        if (quantity > 125 || quantity == 0) return false;
+        
+        last_exception = 0;
+        sendRequest(slave_addr, MODBUS_FC_READ_INPUT_REGISTERS, start_addr, quantity);
+        
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_READ_INPUT_REGISTERS);
+        if (!registersReply(length, quantity)) return false;
+        
+        unpackRegisters(quantity, data);
+        return true;
+    }
+    
+    // Write Single Coil (FC 0x05)
+    bool writeSingleCoil(uint8_t slave_addr, uint16_t addr, bool value) {
+        last_exception = 0;
+        uint16_t coil_value = value ? 0xFF00 : 0x0000;
+        sendRequest(slave_addr, MODBUS_FC_WRITE_SINGLE_COIL, addr, coil_value);
+        
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_WRITE_SINGLE_COIL);
+        return echoReply(length, addr, coil_value);
+    }
+    
+    // Write Single Register (FC 0x06)
+    bool writeSingleRegister(uint8_t slave_addr, uint16_t addr, uint16_t value) {
+        last_exception = 0;
+        sendRequest(slave_addr, MODBUS_FC_WRITE_SINGLE_REGISTER, addr, value);
+        
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_WRITE_SINGLE_REGISTER);
+        return echoReply(length, addr, value);
+    }
+    
+    // Write Multiple Coils (FC 0x0F)
+    bool writeMultipleCoils(uint8_t slave_addr, uint16_t start_addr, uint16_t quantity, bool* data) {
+        if (quantity > 1968 || quantity == 0) return false;
+        
+        last_exception = 0;
+        uint8_t byte_count = (quantity + 7) / 8;
+        uint8_t coil_data[246];  // Max bytes for coils
+        
+        packCoils(data, quantity, coil_data);
+        
+        sendRequest(slave_addr, MODBUS_FC_WRITE_MULTIPLE_COILS, start_addr, quantity, 
+                   coil_data, byte_count);
+        
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_WRITE_MULTIPLE_COILS);
+        return echoReply(length, start_addr, quantity);
+    }
+    
+    // Write Multiple Registers (FC 0x10)
+    bool writeMultipleRegisters(uint8_t slave_addr, uint16_t start_addr, uint16_t quantity, uint16_t* data) {
+        if (quantity > 123 || quantity == 0) return false;
+        
+        last_exception = 0;
+        uint8_t byte_count = quantity * 2;
+        uint8_t reg_data[246];  // Max bytes for registers
+        
+        packRegisters(data, quantity, reg_data);
+        
+        sendRequest(slave_addr, MODBUS_FC_WRITE_MULTIPLE_REGISTERS, start_addr, quantity, 
+                   reg_data, byte_count);
+        
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_WRITE_MULTIPLE_REGISTERS);
+        return echoReply(length, start_addr, quantity);
+    }
+    
+    // Mask Write Register (FC 0x16): reg = (reg & and_mask) | (or_mask & ~and_mask)
+    bool maskWriteRegister(uint8_t slave_addr, uint16_t addr, uint16_t and_mask, uint16_t or_mask) {
+        last_exception = 0;
+        sendMaskWrite(slave_addr, addr, and_mask, or_mask);
+        
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_MASK_WRITE_REGISTER);
+        return maskReply(length, addr, and_mask, or_mask);
+    }
+    
+    // Read/Write Multiple Registers (FC 0x17): the write is performed
+    // before the read, in a single transaction
+    bool readWriteMultipleRegisters(uint8_t slave_addr,
+                                    uint16_t read_addr, uint16_t read_quantity, uint16_t* read_data,
+                                    uint16_t write_addr, uint16_t write_quantity, const uint16_t* write_data) {
+        if (read_quantity > 125 || read_quantity == 0) return false;
+        if (write_quantity > 121 || write_quantity == 0) return false;
+        
+        last_exception = 0;
+        sendReadWrite(slave_addr, read_addr, read_quantity, write_addr, write_quantity, write_data);
+        
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_READ_WRITE_REGISTERS);
+        if (!registersReply(length, read_quantity)) return false;
+        
+        unpackRegisters(read_quantity, read_data);
+        return true;
+    }
+    
+    // Diagnostics (FC 0x08). `result` receives the data field of the
+    // reply, e.g. the counter value for MODBUS_DIAG_*_COUNT.
+    bool diagnostics(uint8_t slave_addr, uint16_t sub_function, uint16_t data = 0,
+                     uint16_t* result = nullptr) {
+        last_exception = 0;
+        sendRequest(slave_addr, MODBUS_FC_DIAGNOSTICS, sub_function, data);
+        
+        uint16_t length = waitResponse(slave_addr, MODBUS_FC_DIAGNOSTICS);
+        if (length < 6 || rxWord(2) != sub_function) return false;
+        
+        if (result) *result = rxWord(4);
+        return true;
+    }
+};
+
+// ==================== MODBUS POLLER ====================
+// Cyclic reads for a supervisory master. Items that sit next to each
+// other (same slave and function code) are merged into as few requests
+// as the 125-register / 2000-bit limits allow, run on their period, and
+// published into a snapshot that the application reads at leisure.
+//   ModbusPoller<> poller(&master);
+//   int8_t temps = poller.add(1, MODBUS_FC_READ_INPUT_REGISTERS, 0, 8, 500);
+//   forever() { poller.poll(); ... poller.getRegister(temps, 3); }
+template<uint8_t MAX_ITEMS = 32, uint16_t MAX_REGISTERS = 512, uint16_t MAX_BITS = 512>
+class ModbusPoller {
+private:
+    struct Item {
+        uint8_t slave;
+        uint8_t function;
+        uint16_t address;
+        uint16_t count;
+        uint32_t period_ms;
+        uint8_t block;
+        uint16_t offset;    // Into registers[] or bits[]
+    };
+    
+    struct Block {
+        uint8_t slave;
+        uint8_t function;
+        uint16_t address;
+        uint16_t count;
+        uint32_t period_ms;
+        uint32_t next_ms;
+        uint32_t updated_ms;
+        uint16_t offset;
+        bool valid;
+        uint8_t last_exception;
+    };
+    
+    ModbusMaster* master;
+    Item items[MAX_ITEMS];
+    Block blocks[MAX_ITEMS];
+    uint8_t item_count;
+    uint8_t block_count;
+    uint16_t max_gap;
+    bool dirty;
+    
+    uint16_t registers[MAX_REGISTERS ? MAX_REGISTERS : 1];
+    bool bits[MAX_BITS ? MAX_BITS : 1];
+    
+    static bool isBitFunction(uint8_t function) {
+        return function == MODBUS_FC_READ_COILS || function == MODBUS_FC_READ_DISCRETE_INPUTS;
+    }
+    
+    static uint16_t limitFor(uint8_t function) {
+        return isBitFunction(function) ? 2000 : 125;
+    }
+    
+    static bool before(const Item& a, const Item& b) {
+        if (a.slave != b.slave) return a.slave < b.slave;
+        if (a.function != b.function) return a.function < b.function;
+        return a.address < b.address;
+    }
+    
+    bool build() {
+        // Sort item indices by (slave, function, address)
+        uint8_t order[MAX_ITEMS];
+        for (uint8_t i = 0; i < item_count; i++) {
+            uint8_t j = i;
+            while (j > 0 && before(items[i], items[order[j - 1]])) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+        }
+        
+        // Merge neighbours into blocks
+        block_count = 0;
+        for (uint8_t k = 0; k < item_count; k++) {
+            Item& item = items[order[k]];
+            uint32_t item_end = (uint32_t)item.address + item.count;
+            
+            if (block_count > 0) {
+                Block& b = blocks[block_count - 1];
+                uint32_t block_end = (uint32_t)b.address + b.count;
+                uint32_t merged_end = item_end > block_end ? item_end : block_end;
+                
+                if (b.slave == item.slave && b.function == item.function &&
+                    item.address <= block_end + max_gap &&
+                    merged_end - b.address <= limitFor(item.function)) {
+                    b.count = merged_end - b.address;
+                    if (item.period_ms < b.period_ms) b.period_ms = item.period_ms;
+                    item.block = block_count - 1;
+                    continue;
+                }
+            }
+            
+            Block& b = blocks[block_count];
+            b.slave = item.slave;
+            b.function = item.function;
+            b.address = item.address;
+            b.count = item.count;
+            b.period_ms = item.period_ms;
+            item.block = block_count++;
+        }
+        
+        // Lay blocks out in the snapshot
+        uint16_t reg_offset = 0;
+        uint16_t bit_offset = 0;
+        uint32_t now = millis();
+        for (uint8_t i = 0; i < block_count; i++) {
+            Block& b = blocks[i];
+            uint16_t& offset = isBitFunction(b.function) ? bit_offset : reg_offset;
+            uint16_t capacity = isBitFunction(b.function) ? MAX_BITS : MAX_REGISTERS;
+            
+            if ((uint32_t)offset + b.count > capacity) {
+                block_count = 0;
+                return false;
+            }
+            
+            b.offset = offset;
+            b.next_ms = now;
+            b.updated_ms = 0;
+            b.valid = false;
+            b.last_exception = 0;
+            offset += b.count;
+        }
+        
+        for (uint8_t i = 0; i < item_count; i++) {
+            Item& item = items[i];
+            item.offset = blocks[item.block].offset + (item.address - blocks[item.block].address);
+        }
+        
+        dirty = false;
+        return true;
+    }
+    
+    bool runBlock(Block& b) {
+        switch (b.function) {
+            case MODBUS_FC_READ_COILS:
+                return master->readCoils(b.slave, b.address, b.count, &bits[b.offset]);
+            case MODBUS_FC_READ_DISCRETE_INPUTS:
+                return master->readDiscreteInputs(b.slave, b.address, b.count, &bits[b.offset]);
+            case MODBUS_FC_READ_HOLDING_REGISTERS:
+                return master->readHoldingRegisters(b.slave, b.address, b.count, &registers[b.offset]);
+            case MODBUS_FC_READ_INPUT_REGISTERS:
+                return master->readInputRegisters(b.slave, b.address, b.count, &registers[b.offset]);
+            default:
+                return false;
+        }
+    }
+
+public:
+    explicit ModbusPoller(ModbusMaster* m)
+        : master(m), item_count(0), block_count(0), max_gap(0), dirty(false) {
+        memset(registers, 0, sizeof(registers));
+        memset(bits, 0, sizeof(bits));
+    }
+    
+    // Declare a cyclic read (FC 0x01-0x04). Returns an item handle or -1.
+    int8_t add(uint8_t slave, uint8_t function, uint16_t address, uint16_t count, uint32_t period_ms) {
+        if (item_count >= MAX_ITEMS) return -1;
+        if (function < MODBUS_FC_READ_COILS || function > MODBUS_FC_READ_INPUT_REGISTERS) return -1;
+        if (count == 0 || count > limitFor(function)) return -1;
+        
+        Item& item = items[item_count];
+        item.slave = slave;
+        item.function = function;
+        item.address = address;
+        item.count = count;
+        item.period_ms = period_ms;
+        dirty = true;
+        return (int8_t)item_count++;
+    }
+    
+    // Also merge items separated by up to `gap` unused addresses
+    void setMaxGap(uint16_t gap) {
+        max_gap = gap;
+        dirty = true;
+    }
+    
+    // Issue every request that is due. Returns the number of requests sent.
+    uint8_t poll() {
+        if (dirty && !build()) return 0;
+        
+        uint8_t sent = 0;
+        for (uint8_t i = 0; i < block_count; i++) {
+            Block& b = blocks[i];
+            uint32_t now = millis();
+            if ((int32_t)(now - b.next_ms) < 0) continue;
+            
+            b.valid = runBlock(b);
+            b.last_exception = master->getLastException();
+            if (b.valid) b.updated_ms = millis();
+            
+            // Keep the schedule phase, but don't try to catch up missed slots
+            b.next_ms += b.period_ms;
+            if ((int32_t)(millis() - b.next_ms) >= 0) b.next_ms = millis() + b.period_ms;
+            sent++;
+        }
+        return sent;
+    }
+    
+    // Number of requests per full cycle after merging
+    uint8_t getRequestCount() {
+        if (dirty) build();
+        return block_count;
+    }
+    
+    bool isValid(int8_t item) const {
+        if (item < 0 || item >= item_count || dirty) return false;
+        return blocks[items[item].block].valid;
+    }
+    
+    uint8_t getLastException(int8_t item) const {
+        if (item < 0 || item >= item_count || dirty) return 0;
+        return blocks[items[item].block].last_exception;
+    }
+    
+    // millis() of the last successful update
+    uint32_t getUpdateTime(int8_t item) const {
+        if (item < 0 || item >= item_count || dirty) return 0;
+        return blocks[items[item].block].updated_ms;
+    }
+    
+    uint16_t getRegister(int8_t item, uint16_t index) const {
+        if (item < 0 || item >= item_count || dirty) return 0;
+        const Item& it = items[item];
+        if (isBitFunction(it.function) || index >= it.count) return 0;
+        return registers[it.offset + index];
+    }
+    
+    bool getBit(int8_t item, uint16_t index) const {
+        if (item < 0 || item >= item_count || dirty) return false;
+        const Item& it = items[item];
+        if (!isBitFunction(it.function) || index >= it.count) return false;
+        return bits[it.offset + index];
+    }
+    
+    // Direct view into the snapshot for register items
+    const uint16_t* getRegisters(int8_t item) const {
+        if (item < 0 || item >= item_count || dirty) return nullptr;
+        if (isBitFunction(items[item].function)) return nullptr;
+        return &registers[items[item].offset];
+    }
+};
+
+// ==================== MODBUS BIT TABLES ====================
+// Coils and discrete inputs are stored packed, 32 per word
+struct ModbusBits {
+    static constexpr uint16_t words(uint16_t count) {
+        return count ? (count + 31) / 32 : 1;
+    }
+
+    static bool get(const uint32_t* table, uint16_t index) {
+        return (table[index >> 5] >> (index & 31)) & 1U;
+    }
+
+    static void set(uint32_t* table, uint16_t index, bool value) {
+        if (value) table[index >> 5] |= (1UL << (index & 31));
+        else table[index >> 5] &= ~(1UL << (index & 31));
+    }
+
+    // Pack `count` bits starting at `first` into Modbus byte order (LSB first)
+    static void pack(const uint32_t* table, uint16_t table_words,
+                     uint16_t first, uint16_t count, uint8_t* out) {
+        uint16_t byte_count = (count + 7) / 8;
+        for (uint16_t i = 0; i < byte_count; i++) {
+            uint32_t bit = first + i * 8;
+            uint16_t word = bit >> 5;
+            uint8_t shift = bit & 31;
+            uint32_t value = table[word] >> shift;
+            if (shift > 24 && word + 1 < table_words) {
+                value |= table[word + 1] << (32 - shift);
+            }
+            out[i] = (uint8_t)value;
+        }
+        if (count & 7) {
+            out[byte_count - 1] &= (uint8_t)((1U << (count & 7)) - 1);
         }
-        
-        return true;
     }
-    
-    // Read Input Registers (FC 0x04)
-    bool readInputRegisters(uint8_t slave_addr, uint16_t start_addr, uint16_t quantity, uint16_t* data) {
-        if (quantity > 125 || quantity == 0) return false;
-        
-        last_exception = 0;
-        sendRequest(slave_addr, MODBUS_FC_READ_INPUT_REGISTERS, start_addr, quantity);
-        
-        if (!waitResponse()) return false;
-        
-        uint8_t byte_count = rx_buffer[2];
-        for (uint16_t i = 0; i < quantity; i++) {
-            data[i] = ((uint16_t)rx_buffer[3 + i * 2] << 8) | rx_buffer[4 + i * 2];
+
+    // Unpack `count` bits in Modbus byte order into the table at `first`
+    static void unpack(uint32_t* table, uint16_t table_words,
+                       uint16_t first, uint16_t count, const uint8_t* in) {
+        uint16_t byte_count = (count + 7) / 8;
+        for (uint16_t i = 0; i < byte_count; i++) {
+            uint8_t bits = (i == byte_count - 1 && (count & 7)) ? (count & 7) : 8;
+            uint32_t mask = (1UL << bits) - 1;
+            uint32_t value = in[i] & mask;
+            uint32_t bit = first + i * 8;
+            uint16_t word = bit >> 5;
+            uint8_t shift = bit & 31;
+
+            table[word] = (table[word] & ~(mask << shift)) | (value << shift);
+            if (shift + bits > 32 && word + 1 < table_words) {
+                uint8_t spill = 32 - shift;
+                table[word + 1] = (table[word + 1] & ~(mask >> spill)) | (value >> spill);
+            }
         }
-        
+    }
+};
+
+// ==================== MODBUS REGISTER RANGES ====================
+// Address ranges linked to live data. Values are read from / written to a
+// backing array, or produced on demand by callbacks when a master asks.
+#define MODBUS_MAX_RANGES                   16
+#define MODBUS_RANGE_CHUNK                  32    // values per callback call
+
+#define MODBUS_COILS                        0
+#define MODBUS_DISCRETE_INPUTS              1
+#define MODBUS_HOLDING_REGISTERS            2
+#define MODBUS_INPUT_REGISTERS              3
+
+// Fill/consume `count` values starting at `addr`. Bit tables use 0/1.
+// Return false to answer with a slave device failure exception.
+typedef bool (*ModbusReadCallback)(uint16_t addr, uint16_t count, uint16_t* values);
+typedef bool (*ModbusWriteCallback)(uint16_t addr, uint16_t count, const uint16_t* values);
+
+struct ModbusRange {
+    uint8_t table;
+    uint16_t start;
+    uint16_t count;
+    bool* bits;
+    uint16_t* registers;
+    ModbusReadCallback on_read;
+    ModbusWriteCallback on_write;
+};
+
+// ==================== MODBUS HANDLER ====================
+// Transport-independent request execution, implemented by ModbusSlaveT
+// and used by transports other than RTU (see ArduLiteESP_MODBUS_TCP.h)
+class ModbusHandler {
+public:
+    virtual ~ModbusHandler() {}
+    
+    // Execute `request` (function code + data) and write the reply PDU
+    // into `response` (at least MODBUS_MAX_BUFFER bytes). Returns its
+    // length, or 0 if there is nothing to send.
+    virtual uint16_t handlePDU(const uint8_t* request, uint16_t length, uint8_t* response) = 0;
+    
+    // Whether a request for Modbus TCP unit `unit` is meant for this
+    // handler. The default serves every unit.
+    virtual bool acceptsUnit(uint8_t unit) {
         return true;
     }
+};
+
+// ==================== MODBUS SLAVE ====================
+// Map sizes and base addresses are fixed at compile time, e.g.
+//   ModbusSlaveT<2000, 64, 4000, 100> slave(&uart1, 1);
+// ModbusSlave keeps the classic 256-entry maps starting at address 0.
+template<uint16_t NUM_COILS = 256,
+         uint16_t NUM_DISCRETE_INPUTS = 256,
+         uint16_t NUM_HOLDING_REGISTERS = 256,
+         uint16_t NUM_INPUT_REGISTERS = 256,
+         uint16_t COIL_BASE = 0,
+         uint16_t DISCRETE_INPUT_BASE = 0,
+         uint16_t HOLDING_REGISTER_BASE = 0,
+         uint16_t INPUT_REGISTER_BASE = 0>
+class ModbusSlaveT : public ModbusRTU, public ModbusHandler {
+private:
+    inline static constexpr uint16_t COIL_WORDS = ModbusBits::words(NUM_COILS);
+    inline static constexpr uint16_t DISCRETE_WORDS = ModbusBits::words(NUM_DISCRETE_INPUTS);
+
+    // Memory maps
+    uint32_t coils[COIL_WORDS];
+    uint32_t discrete_inputs[DISCRETE_WORDS];
+    uint16_t holding_registers[NUM_HOLDING_REGISTERS ? NUM_HOLDING_REGISTERS : 1];
+    uint16_t input_registers[NUM_INPUT_REGISTERS ? NUM_INPUT_REGISTERS : 1];
     
-    // Write Single Coil (FC 0x05)
-    bool writeSingleCoil(uint8_t slave_addr, uint16_t addr, bool value) {
-        last_exception = 0;
-        uint16_t coil_value = value ? 0xFF00 : 0x0000;
-        sendRequest(slave_addr, MODBUS_FC_WRITE_SINGLE_COIL, addr, coil_value);
-        
-        return waitResponse();
+    // Linked ranges, checked before the built-in maps
+    ModbusRange ranges[MODBUS_MAX_RANGES];
+    uint8_t range_count;
+    
+    // Diagnostics counters (FC 0x08)
+    uint16_t bus_message_count;
+    uint16_t bus_crc_error_count;
+    uint16_t exception_count;
+    uint16_t slave_message_count;
+    uint16_t no_response_count;
+    bool broadcast;
+    uint16_t tx_length;
+    
+    // True if [start_addr, start_addr + quantity) lies inside the map
+    static bool inRange(uint16_t base, uint16_t size, uint16_t start_addr, uint16_t quantity) {
+        return start_addr >= base &&
+               (uint32_t)(start_addr - base) + quantity <= size;
     }
     
-    // Write Single Register (FC 0x06)
-    bool writeSingleRegister(uint8_t slave_addr, uint16_t addr, uint16_t value) {
-        last_exception = 0;
-        sendRequest(slave_addr, MODBUS_FC_WRITE_SINGLE_REGISTER, addr, value);
-        
-        return waitResponse();
+    const ModbusRange* findRange(uint8_t table, uint16_t addr) const {
+        for (uint8_t i = 0; i < range_count; i++) {
+            const ModbusRange& r = ranges[i];
+            if (r.table == table && addr >= r.start && addr - r.start < r.count) {
+                return &r;
+            }
+        }
+        return nullptr;
     }
     
-    // Write Multiple Coils (FC 0x0F)
-    bool writeMultipleCoils(uint8_t slave_addr, uint16_t start_addr, uint16_t quantity, bool* data) {
-        if (quantity > 1968 || quantity == 0) return false;
-        
-        last_exception = 0;
-        uint8_t byte_count = (quantity + 7) / 8;
-        uint8_t coil_data[246];  // Max bytes for coils
-        
-        memset(coil_data, 0, byte_count);
-        
-        for (uint16_t i = 0; i < quantity; i++) {
-            if (data[i]) {
-                uint16_t byte_index = i / 8;
-                uint8_t bit_index = i % 8;
-                coil_data[byte_index] |= (1 << bit_index);
+    bool addRange(uint8_t table, uint16_t start, uint16_t count, bool* bits, uint16_t* registers,
+                  ModbusReadCallback on_read, ModbusWriteCallback on_write) {
+        if (count == 0 || range_count >= MODBUS_MAX_RANGES) return false;
+        if ((uint32_t)start + count > 0x10000UL) return false;
+        
+        for (uint8_t i = 0; i < range_count; i++) {
+            const ModbusRange& r = ranges[i];
+            if (r.table == table && start < r.start + r.count && r.start < start + count) {
+                return false;  // Overlaps an existing range
             }
         }
         
-        sendRequest(slave_addr, MODBUS_FC_WRITE_MULTIPLE_COILS, start_addr, quantity, 
-                   coil_data, byte_count);
-        
-        return waitResponse();
+        ranges[range_count++] = { table, start, count, bits, registers, on_read, on_write };
+        return true;
     }
     
-    // Write Multiple Registers (FC 0x10)
-    bool writeMultipleRegisters(uint8_t slave_addr, uint16_t start_addr, uint16_t quantity, uint16_t* data) {
-        if (quantity > 123 || quantity == 0) return false;
-        
-        last_exception = 0;
-        uint8_t byte_count = quantity * 2;
-        uint8_t reg_data[246];  // Max bytes for registers
-        
-        for (uint16_t i = 0; i < quantity; i++) {
-            reg_data[i * 2] = (data[i] >> 8) & 0xFF;
-            reg_data[i * 2 + 1] = data[i] & 0xFF;
+    // Read `quantity` values through linked ranges (which may be adjacent)
+    // and encode them into `out` in wire format. Returns 0 or an exception.
+    uint8_t readRanges(uint8_t table, uint16_t start_addr, uint16_t quantity, uint8_t* out) {
+        bool bit_table = (table == MODBUS_COILS || table == MODBUS_DISCRETE_INPUTS);
+        uint16_t values[MODBUS_RANGE_CHUNK];
+        uint16_t done = 0;
+        
+        // The address space ends at 0xFFFF; a request must not wrap to 0
+        if ((uint32_t)start_addr + quantity > 0x10000UL) return MODBUS_EX_ILLEGAL_DATA_ADDRESS;
+        
+        if (bit_table) memset(out, 0, (quantity + 7) / 8);
+        
+        while (done < quantity) {
+            uint16_t addr = start_addr + done;
+            const ModbusRange* r = findRange(table, addr);
+            if (!r) return MODBUS_EX_ILLEGAL_DATA_ADDRESS;
+            
+            uint16_t n = quantity - done;
+            if (n > r->start + r->count - addr) n = r->start + r->count - addr;
+            if (n > MODBUS_RANGE_CHUNK) n = MODBUS_RANGE_CHUNK;
+            
+            uint16_t offset = addr - r->start;
+            if (r->on_read) {
+                if (!r->on_read(addr, n, values)) return MODBUS_EX_SLAVE_DEVICE_FAILURE;
+            } else if (r->registers) {
+                memcpy(values, &r->registers[offset], n * sizeof(uint16_t));
+            } else if (r->bits) {
+                for (uint16_t i = 0; i < n; i++) values[i] = r->bits[offset + i];
+            } else {
+                return MODBUS_EX_ILLEGAL_DATA_ADDRESS;
+            }
+            
+            for (uint16_t i = 0; i < n; i++, done++) {
+                if (bit_table) {
+                    if (values[i]) out[done >> 3] |= (1 << (done & 7));
+                } else {
+                    out[done * 2] = (values[i] >> 8) & 0xFF;
+                    out[done * 2 + 1] = values[i] & 0xFF;
+                }
+            }
+        }
+        return 0;
+    }
+    
+    // Decode `quantity` wire-format values from `in` into linked ranges
+    uint8_t writeRanges(uint8_t table, uint16_t start_addr, uint16_t quantity, const uint8_t* in) {
+        bool bit_table = (table == MODBUS_COILS);
+        uint16_t values[MODBUS_RANGE_CHUNK];
+        uint16_t done = 0;
+        
+        if ((uint32_t)start_addr + quantity > 0x10000UL) return MODBUS_EX_ILLEGAL_DATA_ADDRESS;
+        
+        // Validate the whole request before touching any data
+        for (uint16_t checked = 0; checked < quantity; ) {
+            const ModbusRange* r = findRange(table, start_addr + checked);
+            if (!r || (!r->on_write && !r->bits && !r->registers)) return MODBUS_EX_ILLEGAL_DATA_ADDRESS;
+            checked += r->start + r->count - (start_addr + checked);
         }
         
-        sendRequest(slave_addr, MODBUS_FC_WRITE_MULTIPLE_REGISTERS, start_addr, quantity, 
-                   reg_data, byte_count);
-        
-        return waitResponse();
+        while (done < quantity) {
+            uint16_t addr = start_addr + done;
+            const ModbusRange* r = findRange(table, addr);
+            
+            uint16_t n = quantity - done;
+            if (n > r->start + r->count - addr) n = r->start + r->count - addr;
+            if (n > MODBUS_RANGE_CHUNK) n = MODBUS_RANGE_CHUNK;
+            
+            for (uint16_t i = 0; i < n; i++) {
+                uint16_t k = done + i;
+                values[i] = bit_table ? ((in[k >> 3] >> (k & 7)) & 0x01)
+                                      : (((uint16_t)in[k * 2] << 8) | in[k * 2 + 1]);
+            }
+            
+            uint16_t offset = addr - r->start;
+            if (r->on_write) {
+                if (!r->on_write(addr, n, values)) return MODBUS_EX_SLAVE_DEVICE_FAILURE;
+            } else if (r->registers) {
+                memcpy(&r->registers[offset], values, n * sizeof(uint16_t));
+            } else {
+                for (uint16_t i = 0; i < n; i++) r->bits[offset + i] = values[i];
+            }
+            done += n;
+        }
+        return 0;
     }
-};
-
-// ==================== MODBUS SLAVE ====================
-class ModbusSlave : public ModbusRTU {
-private:
-    // Memory maps
-    bool coils[256];
-    bool discrete_inputs[256];
-    uint16_t holding_registers[256];
-    uint16_t input_registers[256];
     
-    void sendException(uint8_t function_code, uint8_t exception_code) {
+    // Handlers build the reply (address + PDU) in tx_buffer; the
+    // transport frames and sends it
+    void replyException(uint8_t function_code, uint8_t exception_code) {
+        exception_count++;
         tx_buffer[0] = device_address;
         tx_buffer[1] = function_code | 0x80;
         tx_buffer[2] = exception_code;
-        addCRC16(tx_buffer, 3);
-        sendFrame(tx_buffer, 5);
+        tx_length = 3;
     }
     
-    void sendResponse(uint16_t length) {
-        addCRC16(tx_buffer, length);
-        sendFrame(tx_buffer, length + 2);
+    void reply(uint16_t length) {
+        tx_length = length;
     }
     
-    void handleReadCoils(uint16_t start_addr, uint16_t quantity) {
-        if (quantity == 0 || quantity > 2000) {
-            sendException(MODBUS_FC_READ_COILS, MODBUS_EX_ILLEGAL_DATA_VALUE);
-            return;
+    // Holding register access through linked ranges or the built-in map,
+    // in wire format. Return 0 or an exception code.
+    uint8_t readHolding(uint16_t start_addr, uint16_t quantity, uint8_t* out) {
+        if (findRange(MODBUS_HOLDING_REGISTERS, start_addr)) {
+            return readRanges(MODBUS_HOLDING_REGISTERS, start_addr, quantity, out);
         }
-        
-        if (start_addr + quantity > 256) {
-            sendException(MODBUS_FC_READ_COILS, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
-            return;
+        if (!inRange(HOLDING_REGISTER_BASE, NUM_HOLDING_REGISTERS, start_addr, quantity)) {
+            return MODBUS_EX_ILLEGAL_DATA_ADDRESS;
         }
-        
-        uint16_t index = 0;
-        tx_buffer[index++] = device_address;
-        tx_buffer[index++] = MODBUS_FC_READ_COILS;
-        
-        uint8_t byte_count = (quantity + 7) / 8;
-        tx_buffer[index++] = byte_count;
-        
-        for (uint8_t i = 0; i < byte_count; i++) {
-            uint8_t byte_value = 0;
-            for (uint8_t bit = 0; bit < 8 && (i * 8 + bit) < quantity; bit++) {
-                if (coils[start_addr + i * 8 + bit]) {
-                    byte_value |= (1 << bit);
-                }
-            }
-            tx_buffer[index++] = byte_value;
+        const uint16_t* regs = &holding_registers[start_addr - HOLDING_REGISTER_BASE];
+        for (uint16_t i = 0; i < quantity; i++) {
+            out[i * 2] = (regs[i] >> 8) & 0xFF;
+            out[i * 2 + 1] = regs[i] & 0xFF;
         }
-        
-        sendResponse(index);
+        return 0;
     }
     
-    void handleReadDiscreteInputs(uint16_t start_addr, uint16_t quantity) {
-        if (quantity == 0 || quantity > 2000) {
-            sendException(MODBUS_FC_READ_DISCRETE_INPUTS, MODBUS_EX_ILLEGAL_DATA_VALUE);
-            return;
+    uint8_t writeHolding(uint16_t start_addr, uint16_t quantity, const uint8_t* in) {
+        if (findRange(MODBUS_HOLDING_REGISTERS, start_addr)) {
+            return writeRanges(MODBUS_HOLDING_REGISTERS, start_addr, quantity, in);
         }
-        
-        if (start_addr + quantity > 256) {
-            sendException(MODBUS_FC_READ_DISCRETE_INPUTS, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
-            return;
+        if (!inRange(HOLDING_REGISTER_BASE, NUM_HOLDING_REGISTERS, start_addr, quantity)) {
+            return MODBUS_EX_ILLEGAL_DATA_ADDRESS;
         }
-        
-        uint16_t index = 0;
-        tx_buffer[index++] = device_address;
-        tx_buffer[index++] = MODBUS_FC_READ_DISCRETE_INPUTS;
-        
-        uint8_t byte_count = (quantity + 7) / 8;
-        tx_buffer[index++] = byte_count;
-        
-        for (uint8_t i = 0; i < byte_count; i++) {
-            uint8_t byte_value = 0;
-            for (uint8_t bit = 0; bit < 8 && (i * 8 + bit) < quantity; bit++) {
-                if (discrete_inputs[start_addr + i * 8 + bit]) {
-                    byte_value |= (1 << bit);
-                }
-            }
-            tx_buffer[index++] = byte_value;
+        uint16_t* regs = &holding_registers[start_addr - HOLDING_REGISTER_BASE];
+        for (uint16_t i = 0; i < quantity; i++) {
+            regs[i] = ((uint16_t)in[i * 2] << 8) | in[i * 2 + 1];
         }
-        
-        sendResponse(index);
+        return 0;
     }
     
-    void handleReadHoldingRegisters(uint16_t start_addr, uint16_t quantity) {
-        if (quantity == 0 || quantity > 125) {
-            sendException(MODBUS_FC_READ_HOLDING_REGISTERS, MODBUS_EX_ILLEGAL_DATA_VALUE);
+    void handleReadBits(uint8_t function_code, const uint32_t* table, uint16_t table_words,
+                        uint16_t base, uint16_t size, uint16_t start_addr, uint16_t quantity) {
+        if (quantity == 0 || quantity > 2000) {
+            replyException(function_code, MODBUS_EX_ILLEGAL_DATA_VALUE);
             return;
         }
         
-        if (start_addr + quantity > 256) {
-            sendException(MODBUS_FC_READ_HOLDING_REGISTERS, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+        uint8_t table_id = function_code - 1;  // FC01/FC02 -> coils/discrete inputs
+        bool linked = findRange(table_id, start_addr) != nullptr;
+        
+        if (!linked && !inRange(base, size, start_addr, quantity)) {
+            replyException(function_code, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
             return;
         }
         
         uint16_t index = 0;
         tx_buffer[index++] = device_address;
-        tx_buffer[index++] = MODBUS_FC_READ_HOLDING_REGISTERS;
+        tx_buffer[index++] = function_code;
         
-        uint8_t byte_count = quantity * 2;
+        uint8_t byte_count = (quantity + 7) / 8;
         tx_buffer[index++] = byte_count;
         
-        for (uint16_t i = 0; i < quantity; i++) {
-            tx_buffer[index++] = (holding_registers[start_addr + i] >> 8) & 0xFF;
-            tx_buffer[index++] = holding_registers[start_addr + i] & 0xFF;
+        if (linked) {
+            uint8_t exception = readRanges(table_id, start_addr, quantity, &tx_buffer[index]);
+            if (exception) {
+                replyException(function_code, exception);
+                return;
+            }
+        } else {
+            ModbusBits::pack(table, table_words, start_addr - base, quantity, &tx_buffer[index]);
         }
+        index += byte_count;
         
-        sendResponse(index);
+        reply(index);
     }
     
-    void handleReadInputRegisters(uint16_t start_addr, uint16_t quantity) {
+    void handleReadRegisters(uint8_t function_code, const uint16_t* table,
+                             uint16_t base, uint16_t size, uint16_t start_addr, uint16_t quantity) {
         if (quantity == 0 || quantity > 125) {
-            sendException(MODBUS_FC_READ_INPUT_REGISTERS, MODBUS_EX_ILLEGAL_DATA_VALUE);
+            replyException(function_code, MODBUS_EX_ILLEGAL_DATA_VALUE);
             return;
         }
         
-        if (start_addr + quantity > 256) {
-            sendException(MODBUS_FC_READ_INPUT_REGISTERS, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+        uint8_t table_id = function_code - 1;  // FC03/FC04 -> holding/input registers
+        bool linked = findRange(table_id, start_addr) != nullptr;
+        
+        if (!linked && !inRange(base, size, start_addr, quantity)) {
+            replyException(function_code, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
             return;
         }
         
         uint16_t index = 0;
         tx_buffer[index++] = device_address;
-        tx_buffer[index++] = MODBUS_FC_READ_INPUT_REGISTERS;
+        tx_buffer[index++] = function_code;
         
         uint8_t byte_count = quantity * 2;
         tx_buffer[index++] = byte_count;
         
-        for (uint16_t i = 0; i < quantity; i++) {
-            tx_buffer[index++] = (input_registers[start_addr + i] >> 8) & 0xFF;
-            tx_buffer[index++] = input_registers[start_addr + i] & 0xFF;
+        if (linked) {
+            uint8_t exception = readRanges(table_id, start_addr, quantity, &tx_buffer[index]);
+            if (exception) {
+                replyException(function_code, exception);
+                return;
+            }
+            index += byte_count;
+        } else {
+            const uint16_t* regs = &table[start_addr - base];
+            for (uint16_t i = 0; i < quantity; i++) {
+                tx_buffer[index++] = (regs[i] >> 8) & 0xFF;
+                tx_buffer[index++] = regs[i] & 0xFF;
+            }
         }
         
-        sendResponse(index);
+        reply(index);
     }
     
     void handleWriteSingleCoil(uint16_t addr, uint16_t value) {
-        if (addr >= 256) {
-            sendException(MODBUS_FC_WRITE_SINGLE_COIL, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+        bool linked = findRange(MODBUS_COILS, addr) != nullptr;
+        
+        if (!linked && !inRange(COIL_BASE, NUM_COILS, addr, 1)) {
+            replyException(MODBUS_FC_WRITE_SINGLE_COIL, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
             return;
         }
         
         if (value != 0x0000 && value != 0xFF00) {
-            sendException(MODBUS_FC_WRITE_SINGLE_COIL, MODBUS_EX_ILLEGAL_DATA_VALUE);
+            replyException(MODBUS_FC_WRITE_SINGLE_COIL, MODBUS_EX_ILLEGAL_DATA_VALUE);
             return;
         }
         
-        coils[addr] = (value == 0xFF00);
+        if (linked) {
+            uint8_t state = (value == 0xFF00) ? 0x01 : 0x00;
+            uint8_t exception = writeRanges(MODBUS_COILS, addr, 1, &state);
+            if (exception) {
+                replyException(MODBUS_FC_WRITE_SINGLE_COIL, exception);
+                return;
+            }
+        } else {
+            ModbusBits::set(coils, addr - COIL_BASE, value == 0xFF00);
+        }
         
         // Echo request
         memcpy(tx_buffer, rx_buffer, 6);
-        sendResponse(6);
+        reply(6);
     }
     
     void handleWriteSingleRegister(uint16_t addr, uint16_t value) {
-        if (addr >= 256) {
-            sendException(MODBUS_FC_WRITE_SINGLE_REGISTER, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+        bool linked = findRange(MODBUS_HOLDING_REGISTERS, addr) != nullptr;
+        
+        if (!linked && !inRange(HOLDING_REGISTER_BASE, NUM_HOLDING_REGISTERS, addr, 1)) {
+            replyException(MODBUS_FC_WRITE_SINGLE_REGISTER, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
             return;
         }
         
-        holding_registers[addr] = value;
+        if (linked) {
+            uint8_t exception = writeRanges(MODBUS_HOLDING_REGISTERS, addr, 1, &rx_buffer[4]);
+            if (exception) {
+                replyException(MODBUS_FC_WRITE_SINGLE_REGISTER, exception);
+                return;
+            }
+        } else {
+            holding_registers[addr - HOLDING_REGISTER_BASE] = value;
+        }
         
         // Echo request
         memcpy(tx_buffer, rx_buffer, 6);
-        sendResponse(6);
+        reply(6);
     }
     
     void handleWriteMultipleCoils(uint16_t start_addr, uint16_t quantity) {
-        if (quantity == 0 || quantity > 1968) {
-            sendException(MODBUS_FC_WRITE_MULTIPLE_COILS, MODBUS_EX_ILLEGAL_DATA_VALUE);
+        uint8_t byte_count = rx_buffer[6];
+        
+        if (quantity == 0 || quantity > 1968 ||
+            byte_count != (quantity + 7) / 8 || rx_length < 9 + byte_count) {
+            replyException(MODBUS_FC_WRITE_MULTIPLE_COILS, MODBUS_EX_ILLEGAL_DATA_VALUE);
             return;
         }
         
-        if (start_addr + quantity > 256) {
-            sendException(MODBUS_FC_WRITE_MULTIPLE_COILS, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+        bool linked = findRange(MODBUS_COILS, start_addr) != nullptr;
+        
+        if (!linked && !inRange(COIL_BASE, NUM_COILS, start_addr, quantity)) {
+            replyException(MODBUS_FC_WRITE_MULTIPLE_COILS, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
             return;
         }
         
-        uint8_t byte_count = rx_buffer[6];
-        
-        for (uint16_t i = 0; i < quantity; i++) {
-            uint16_t byte_index = i / 8;
-            uint8_t bit_index = i % 8;
-            coils[start_addr + i] = (rx_buffer[7 + byte_index] >> bit_index) & 0x01;
+        if (linked) {
+            uint8_t exception = writeRanges(MODBUS_COILS, start_addr, quantity, &rx_buffer[7]);
+            if (exception) {
+                replyException(MODBUS_FC_WRITE_MULTIPLE_COILS, exception);
+                return;
+            }
+        } else {
+            ModbusBits::unpack(coils, COIL_WORDS, start_addr - COIL_BASE, quantity, &rx_buffer[7]);
         }
         
         // Response
@@ -525,25 +1703,36 @@ private:
         tx_buffer[index++] = (quantity >> 8) & 0xFF;
         tx_buffer[index++] = quantity & 0xFF;
         
-        sendResponse(index);
+        reply(index);
     }
     
     void handleWriteMultipleRegisters(uint16_t start_addr, uint16_t quantity) {
-        if (quantity == 0 || quantity > 123) {
-            sendException(MODBUS_FC_WRITE_MULTIPLE_REGISTERS, MODBUS_EX_ILLEGAL_DATA_VALUE);
+        uint8_t byte_count = rx_buffer[6];
+        
+        if (quantity == 0 || quantity > 123 ||
+            byte_count != quantity * 2 || rx_length < 9 + byte_count) {
+            replyException(MODBUS_FC_WRITE_MULTIPLE_REGISTERS, MODBUS_EX_ILLEGAL_DATA_VALUE);
             return;
         }
         
-        if (start_addr + quantity > 256) {
-            sendException(MODBUS_FC_WRITE_MULTIPLE_REGISTERS, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+        bool linked = findRange(MODBUS_HOLDING_REGISTERS, start_addr) != nullptr;
+        
+        if (!linked && !inRange(HOLDING_REGISTER_BASE, NUM_HOLDING_REGISTERS, start_addr, quantity)) {
+            replyException(MODBUS_FC_WRITE_MULTIPLE_REGISTERS, MODBUS_EX_ILLEGAL_DATA_ADDRESS);
             return;
         }
         
-        uint8_t byte_count = rx_buffer[6];
-        
-        for (uint16_t i = 0; i < quantity; i++) {
-            holding_registers[start_addr + i] = ((uint16_t)rx_buffer[7 + i * 2] << 8) | 
-                                                rx_buffer[8 + i * 2];
+        if (linked) {
+            uint8_t exception = writeRanges(MODBUS_HOLDING_REGISTERS, start_addr, quantity, &rx_buffer[7]);
+            if (exception) {
+                replyException(MODBUS_FC_WRITE_MULTIPLE_REGISTERS, exception);
+                return;
+            }
+        } else {
+            uint16_t* regs = &holding_registers[start_addr - HOLDING_REGISTER_BASE];
+            for (uint16_t i = 0; i < quantity; i++) {
+                regs[i] = ((uint16_t)rx_buffer[7 + i * 2] << 8) | rx_buffer[8 + i * 2];
+            }
         }
         
         // Response
@@ -555,64 +1744,274 @@ private:
         tx_buffer[index++] = (quantity >> 8) & 0xFF;
         tx_buffer[index++] = quantity & 0xFF;
         
-        sendResponse(index);
+        reply(index);
+    }
+
+    void handleMaskWriteRegister(uint16_t addr) {
+        if (rx_length < 10) {
+            replyException(MODBUS_FC_MASK_WRITE_REGISTER, MODBUS_EX_ILLEGAL_DATA_VALUE);
+            return;
+        }
+        
+        uint16_t and_mask = ((uint16_t)rx_buffer[4] << 8) | rx_buffer[5];
+        uint16_t or_mask = ((uint16_t)rx_buffer[6] << 8) | rx_buffer[7];
+        
+        uint8_t value[2];
+        uint8_t exception = readHolding(addr, 1, value);
+        if (!exception) {
+            uint16_t current = ((uint16_t)value[0] << 8) | value[1];
+            current = (current & and_mask) | (or_mask & ~and_mask);
+            value[0] = (current >> 8) & 0xFF;
+            value[1] = current & 0xFF;
+            exception = writeHolding(addr, 1, value);
+        }
+        if (exception) {
+            replyException(MODBUS_FC_MASK_WRITE_REGISTER, exception);
+            return;
+        }
+        
+        // Echo request
+        memcpy(tx_buffer, rx_buffer, 8);
+        reply(8);
+    }
+    
+    void handleReadWriteRegisters(uint16_t read_addr, uint16_t read_quantity) {
+        uint16_t write_addr = ((uint16_t)rx_buffer[6] << 8) | rx_buffer[7];
+        uint16_t write_quantity = ((uint16_t)rx_buffer[8] << 8) | rx_buffer[9];
+        uint8_t byte_count = rx_buffer[10];
+        
+        if (read_quantity == 0 || read_quantity > 125 ||
+            write_quantity == 0 || write_quantity > 121 ||
+            byte_count != write_quantity * 2 || rx_length < 13 + byte_count) {
+            replyException(MODBUS_FC_READ_WRITE_REGISTERS, MODBUS_EX_ILLEGAL_DATA_VALUE);
+            return;
+        }
+        
+        // Write happens before the read
+        uint8_t exception = writeHolding(write_addr, write_quantity, &rx_buffer[11]);
+        if (!exception) exception = readHolding(read_addr, read_quantity, &tx_buffer[3]);
+        if (exception) {
+            replyException(MODBUS_FC_READ_WRITE_REGISTERS, exception);
+            return;
+        }
+        
+        tx_buffer[0] = device_address;
+        tx_buffer[1] = MODBUS_FC_READ_WRITE_REGISTERS;
+        tx_buffer[2] = read_quantity * 2;
+        
+        reply(3 + read_quantity * 2);
+    }
+    
+    void handleDiagnostics(uint16_t sub_function, uint16_t data) {
+        uint16_t result = data;
+        
+        switch (sub_function) {
+            case MODBUS_DIAG_RETURN_QUERY_DATA:
+                break;
+            case MODBUS_DIAG_RESTART_COMM:
+            case MODBUS_DIAG_CLEAR_COUNTERS:
+                clearCounters();
+                break;
+            case MODBUS_DIAG_BUS_MESSAGE_COUNT:
+                result = bus_message_count;
+                break;
+            case MODBUS_DIAG_BUS_CRC_ERROR_COUNT:
+                result = bus_crc_error_count;
+                break;
+            case MODBUS_DIAG_EXCEPTION_COUNT:
+                result = exception_count;
+                break;
+            case MODBUS_DIAG_SLAVE_MESSAGE_COUNT:
+                result = slave_message_count;
+                break;
+            case MODBUS_DIAG_NO_RESPONSE_COUNT:
+                result = no_response_count;
+                break;
+            case MODBUS_DIAG_SLAVE_NAK_COUNT:
+            case MODBUS_DIAG_SLAVE_BUSY_COUNT:
+            case MODBUS_DIAG_CHAR_OVERRUN_COUNT:
+                result = 0;
+                break;
+            default:
+                replyException(MODBUS_FC_DIAGNOSTICS, MODBUS_EX_ILLEGAL_FUNCTION);
+                return;
+        }
+        
+        uint16_t index = 0;
+        tx_buffer[index++] = device_address;
+        tx_buffer[index++] = MODBUS_FC_DIAGNOSTICS;
+        tx_buffer[index++] = (sub_function >> 8) & 0xFF;
+        tx_buffer[index++] = sub_function & 0xFF;
+        tx_buffer[index++] = (result >> 8) & 0xFF;
+        tx_buffer[index++] = result & 0xFF;
+        
+        reply(index);
     }
 
 public:
-    ModbusSlave(UART* uart, uint8_t address = 1)
-        : ModbusRTU(uart, address, MODBUS_DEFAULT_TIMEOUT) {
+    ModbusSlaveT(UART* uart, uint8_t address = 1)
+        : ModbusRTU(uart, address, MODBUS_DEFAULT_TIMEOUT), range_count(0), broadcast(false), tx_length(0) {
+        clearCounters();
         memset(coils, 0, sizeof(coils));
         memset(discrete_inputs, 0, sizeof(discrete_inputs));
         memset(holding_registers, 0, sizeof(holding_registers));
         memset(input_registers, 0, sizeof(input_registers));
     }
     
-    // Set/Get memory values
+    // Set/Get memory values (absolute Modbus addresses)
     void setCoil(uint16_t addr, bool value) {
-        if (addr < 256) coils[addr] = value;
+        if (inRange(COIL_BASE, NUM_COILS, addr, 1)) ModbusBits::set(coils, addr - COIL_BASE, value);
     }
     
     bool getCoil(uint16_t addr) {
-        return (addr < 256) ? coils[addr] : false;
+        return inRange(COIL_BASE, NUM_COILS, addr, 1) ? ModbusBits::get(coils, addr - COIL_BASE) : false;
     }
     
     void setDiscreteInput(uint16_t addr, bool value) {
-        if (addr < 256) discrete_inputs[addr] = value;
+        if (inRange(DISCRETE_INPUT_BASE, NUM_DISCRETE_INPUTS, addr, 1)) {
+            ModbusBits::set(discrete_inputs, addr - DISCRETE_INPUT_BASE, value);
+        }
     }
     
     bool getDiscreteInput(uint16_t addr) {
-        return (addr < 256) ? discrete_inputs[addr] : false;
+        return inRange(DISCRETE_INPUT_BASE, NUM_DISCRETE_INPUTS, addr, 1) ?
+               ModbusBits::get(discrete_inputs, addr - DISCRETE_INPUT_BASE) : false;
     }
     
     void setHoldingRegister(uint16_t addr, uint16_t value) {
-        if (addr < 256) holding_registers[addr] = value;
+        if (inRange(HOLDING_REGISTER_BASE, NUM_HOLDING_REGISTERS, addr, 1)) {
+            holding_registers[addr - HOLDING_REGISTER_BASE] = value;
+        }
     }
     
     uint16_t getHoldingRegister(uint16_t addr) {
-        return (addr < 256) ? holding_registers[addr] : 0;
+        return inRange(HOLDING_REGISTER_BASE, NUM_HOLDING_REGISTERS, addr, 1) ?
+               holding_registers[addr - HOLDING_REGISTER_BASE] : 0;
     }
     
     void setInputRegister(uint16_t addr, uint16_t value) {
-        if (addr < 256) input_registers[addr] = value;
+        if (inRange(INPUT_REGISTER_BASE, NUM_INPUT_REGISTERS, addr, 1)) {
+            input_registers[addr - INPUT_REGISTER_BASE] = value;
+        }
     }
     
     uint16_t getInputRegister(uint16_t addr) {
-        return (addr < 256) ? input_registers[addr] : 0;
+        return inRange(INPUT_REGISTER_BASE, NUM_INPUT_REGISTERS, addr, 1) ?
+               input_registers[addr - INPUT_REGISTER_BASE] : 0;
+    }
+    
+    // Link address ranges to live data. Ranges take precedence over the
+    // built-in maps; use ModbusSlaveT<0, 0, 0, 0> for a purely sparse slave.
+    bool mapCoils(uint16_t start, uint16_t count, bool* data) {
+        return addRange(MODBUS_COILS, start, count, data, nullptr, nullptr, nullptr);
+    }
+    
+    bool mapDiscreteInputs(uint16_t start, uint16_t count, bool* data) {
+        return addRange(MODBUS_DISCRETE_INPUTS, start, count, data, nullptr, nullptr, nullptr);
+    }
+    
+    bool mapHoldingRegisters(uint16_t start, uint16_t count, uint16_t* data) {
+        return addRange(MODBUS_HOLDING_REGISTERS, start, count, nullptr, data, nullptr, nullptr);
+    }
+    
+    bool mapInputRegisters(uint16_t start, uint16_t count, uint16_t* data) {
+        return addRange(MODBUS_INPUT_REGISTERS, start, count, nullptr, data, nullptr, nullptr);
+    }
+    
+    bool onCoils(uint16_t start, uint16_t count,
+                 ModbusReadCallback on_read, ModbusWriteCallback on_write = nullptr) {
+        return addRange(MODBUS_COILS, start, count, nullptr, nullptr, on_read, on_write);
+    }
+    
+    bool onDiscreteInputs(uint16_t start, uint16_t count, ModbusReadCallback on_read) {
+        return addRange(MODBUS_DISCRETE_INPUTS, start, count, nullptr, nullptr, on_read, nullptr);
+    }
+    
+    bool onHoldingRegisters(uint16_t start, uint16_t count,
+                            ModbusReadCallback on_read, ModbusWriteCallback on_write = nullptr) {
+        return addRange(MODBUS_HOLDING_REGISTERS, start, count, nullptr, nullptr, on_read, on_write);
+    }
+    
+    bool onInputRegisters(uint16_t start, uint16_t count, ModbusReadCallback on_read) {
+        return addRange(MODBUS_INPUT_REGISTERS, start, count, nullptr, nullptr, on_read, nullptr);
     }
     
+    void clearRanges() {
+        range_count = 0;
+    }
+    
+    void clearCounters() {
+        bus_message_count = 0;
+        bus_crc_error_count = 0;
+        exception_count = 0;
+        slave_message_count = 0;
+        no_response_count = 0;
+    }
+    
+    uint16_t getBusMessageCount() { return bus_message_count; }
+    uint16_t getCRCErrorCount() { return bus_crc_error_count; }
+    uint16_t getExceptionCount() { return exception_count; }
+    uint16_t getSlaveMessageCount() { return slave_message_count; }
+    uint16_t getNoResponseCount() { return no_response_count; }
+    
     // Process incoming requests
     void process() {
-        if (!uart_port->available()) return;
+        if (!uart_port || !uart_port->available()) return;
         
         uint16_t length = receiveFrame(100);
         
         if (length < 5) return;  // Too short
         
+        bus_message_count++;
+        
+        // Check CRC
+        if (!checkCRC16(rx_buffer, length)) {
+            bus_crc_error_count++;
+            return;
+        }
+        
         // Check if this message is for us
         if (rx_buffer[0] != device_address && rx_buffer[0] != 0) return;
         
-        // Check CRC
-        if (!checkCRC16(rx_buffer, length)) return;
+        slave_message_count++;
+        broadcast = (rx_buffer[0] == 0);
+        if (broadcast) no_response_count++;
+        
+        if (dispatch() && !broadcast) sendADU(tx_length);
+    }
+    
+    // Modbus TCP unit: this slave's address, or MODBUS_UNIT_ANY / 0, which
+    // clients use to address a server directly
+    bool acceptsUnit(uint8_t unit) override {
+        return unit == device_address || unit == MODBUS_UNIT_ANY || unit == 0;
+    }
+    
+    // Execute one request PDU from another transport (e.g. Modbus TCP)
+    // against this slave's maps. Returns the response PDU length.
+    uint16_t handlePDU(const uint8_t* request, uint16_t length, uint8_t* response) override {
+        if (length == 0 || length > MODBUS_MAX_BUFFER - 3) return 0;
+        
+        memset(rx_buffer, 0, 8);  // Short PDUs parse as zero fields
+        rx_buffer[0] = device_address;
+        memcpy(&rx_buffer[1], request, length);
+        rx_length = length + 3;  // As if received with address and CRC
+        
+        bus_message_count++;
+        slave_message_count++;
+        broadcast = false;
+        
+        uint16_t reply_length = dispatch();
+        if (reply_length < 2) return 0;
+        
+        memcpy(response, &tx_buffer[1], reply_length - 1);
+        return reply_length - 1;
+    }
+
+private:
+    // Run the request in rx_buffer, leaving the reply in tx_buffer.
+    // Returns the reply length (address + PDU).
+    uint16_t dispatch() {
+        tx_length = 0;
         
         uint8_t function_code = rx_buffer[1];
         uint16_t start_addr = ((uint16_t)rx_buffer[2] << 8) | rx_buffer[3];
@@ -620,19 +2019,23 @@ public:
         
         switch (function_code) {
             case MODBUS_FC_READ_COILS:
-                handleReadCoils(start_addr, quantity);
+                handleReadBits(MODBUS_FC_READ_COILS, coils, COIL_WORDS,
+                               COIL_BASE, NUM_COILS, start_addr, quantity);
                 break;
                 
             case MODBUS_FC_READ_DISCRETE_INPUTS:
-                handleReadDiscreteInputs(start_addr, quantity);
+                handleReadBits(MODBUS_FC_READ_DISCRETE_INPUTS, discrete_inputs, DISCRETE_WORDS,
+                               DISCRETE_INPUT_BASE, NUM_DISCRETE_INPUTS, start_addr, quantity);
                 break;
                 
             case MODBUS_FC_READ_HOLDING_REGISTERS:
-                handleReadHoldingRegisters(start_addr, quantity);
+                handleReadRegisters(MODBUS_FC_READ_HOLDING_REGISTERS, holding_registers,
+                                    HOLDING_REGISTER_BASE, NUM_HOLDING_REGISTERS, start_addr, quantity);
                 break;
                 
             case MODBUS_FC_READ_INPUT_REGISTERS:
-                handleReadInputRegisters(start_addr, quantity);
+                handleReadRegisters(MODBUS_FC_READ_INPUT_REGISTERS, input_registers,
+                                    INPUT_REGISTER_BASE, NUM_INPUT_REGISTERS, start_addr, quantity);
                 break;
                 
             case MODBUS_FC_WRITE_SINGLE_COIL:
@@ -651,11 +2054,27 @@ public:
                 handleWriteMultipleRegisters(start_addr, quantity);
                 break;
                 
+            case MODBUS_FC_DIAGNOSTICS:
+                handleDiagnostics(start_addr, quantity);
+                break;
+                
+            case MODBUS_FC_MASK_WRITE_REGISTER:
+                handleMaskWriteRegister(start_addr);
+                break;
+                
+            case MODBUS_FC_READ_WRITE_REGISTERS:
+                handleReadWriteRegisters(start_addr, quantity);
+                break;
+                
             default:
-                sendException(function_code, MODBUS_EX_ILLEGAL_FUNCTION);
+                replyException(function_code, MODBUS_EX_ILLEGAL_FUNCTION);
                 break;
         }
+        
+        return tx_length;
     }
 };
 
+using ModbusSlave = ModbusSlaveT<>;
+
 #endif
@@ -0,0 +1,379 @@
+#ifndef ARDULITEESP_MODBUS_TCP_H
+#define ARDULITEESP_MODBUS_TCP_H
+
+#include "ArduLiteESP_MODBUS.h"
+
+#ifdef ESP_PLATFORM
+  #include "lwip/sockets.h"
+#else
+  #include <sys/socket.h>
+  #include <sys/select.h>
+  #include <netinet/in.h>
+  #include <netinet/tcp.h>
+  #include <arpa/inet.h>
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Modbus TCP Settings
+#define MODBUS_TCP_PORT                     502
+#define MODBUS_TCP_MAX_CLIENTS              4
+#define MODBUS_TCP_MBAP_SIZE                7     // Transaction, protocol, length, unit
+#define MODBUS_TCP_MAX_ADU                  260
+#define MODBUS_TCP_SEND_TIMEOUT_MS          1000  // Server drops clients that stop reading
+
+// Send the whole buffer on a blocking socket
+inline bool modbus_tcp_send_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        int sent = send(fd, data, length, 0);
+        if (sent <= 0) return false;
+        data += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+inline void modbus_tcp_set_nodelay(int fd) {
+    int flag = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+// ==================== MODBUS TCP SERVER ====================
+// Serves several concurrent connections from one ModbusHandler, normally
+// a ModbusSlave that may also be answering on RTU. Call process() from
+// the same task as the slave's own process() so the maps aren't shared
+// across tasks. Requests for a unit id the handler does not accept (see
+// acceptsUnit()) get no reply, like an RTU frame for another slave.
+//   ModbusSlave slave(&uart1, 1);
+//   ModbusTCPServer server(&slave);
+//   server.begin();
+//   forever() { slave.process(); server.process(10); }
+class ModbusTCPServer {
+private:
+    struct Connection {
+        int fd;
+        uint16_t length;
+        uint8_t buffer[MODBUS_TCP_MAX_ADU];
+    };
+
+    ModbusHandler* handler;
+    uint16_t port;
+    int listen_fd;
+    Connection clients[MODBUS_TCP_MAX_CLIENTS];
+    uint8_t response[MODBUS_TCP_MBAP_SIZE + MODBUS_MAX_BUFFER];
+
+    void acceptClient() {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) return;
+
+        for (uint8_t i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+            if (clients[i].fd < 0) {
+                // A client that never reads must not stall process()
+                struct timeval tv;
+                tv.tv_sec = MODBUS_TCP_SEND_TIMEOUT_MS / 1000;
+                tv.tv_usec = (MODBUS_TCP_SEND_TIMEOUT_MS % 1000) * 1000;
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+                modbus_tcp_set_nodelay(fd);
+                clients[i].fd = fd;
+                clients[i].length = 0;
+                return;
+            }
+        }
+        close(fd);  // No free slot
+    }
+
+    void closeClient(Connection& c) {
+        close(c.fd);
+        c.fd = -1;
+        c.length = 0;
+    }
+
+    void serviceClient(Connection& c) {
+        int n = recv(c.fd, c.buffer + c.length, sizeof(c.buffer) - c.length, 0);
+        if (n <= 0) {
+            closeClient(c);
+            return;
+        }
+        c.length += n;
+
+        // Handle every complete request, requests may be pipelined
+        while (c.length >= MODBUS_TCP_MBAP_SIZE) {
+            uint16_t protocol = ((uint16_t)c.buffer[2] << 8) | c.buffer[3];
+            uint16_t length = ((uint16_t)c.buffer[4] << 8) | c.buffer[5];
+
+            if (protocol != 0 || length < 2 || length > MODBUS_TCP_MAX_ADU - 6) {
+                closeClient(c);
+                return;
+            }
+
+            uint16_t total = 6 + length;
+            if (c.length < total) break;
+
+            uint16_t pdu_length = 0;
+            if (handler->acceptsUnit(c.buffer[6])) {
+                pdu_length = handler->handlePDU(&c.buffer[MODBUS_TCP_MBAP_SIZE], length - 1,
+                                                &response[MODBUS_TCP_MBAP_SIZE]);
+            }
+            if (pdu_length > 0) {
+                memcpy(response, c.buffer, MODBUS_TCP_MBAP_SIZE);  // Echo transaction & unit
+                response[4] = ((pdu_length + 1) >> 8) & 0xFF;
+                response[5] = (pdu_length + 1) & 0xFF;
+
+                if (!modbus_tcp_send_all(c.fd, response, MODBUS_TCP_MBAP_SIZE + pdu_length)) {
+                    closeClient(c);
+                    return;
+                }
+            }
+
+            memmove(c.buffer, c.buffer + total, c.length - total);
+            c.length -= total;
+        }
+    }
+
+public:
+    explicit ModbusTCPServer(ModbusHandler* h, uint16_t listen_port = MODBUS_TCP_PORT)
+        : handler(h), port(listen_port), listen_fd(-1) {
+        for (uint8_t i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+            clients[i].fd = -1;
+            clients[i].length = 0;
+        }
+    }
+
+    ~ModbusTCPServer() {
+        stop();
+    }
+
+    bool begin() {
+        listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listen_fd < 0) return false;
+
+        int reuse = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+
+        if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+            listen(listen_fd, MODBUS_TCP_MAX_CLIENTS) < 0) {
+            close(listen_fd);
+            listen_fd = -1;
+            return false;
+        }
+
+        fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL, 0) | O_NONBLOCK);
+        return true;
+    }
+
+    // Accept new connections and answer complete requests, waiting up to
+    // `timeout_ms` for network activity
+    void process(uint32_t timeout_ms = 0) {
+        if (listen_fd < 0) return;
+
+        fd_set read_set;
+        FD_ZERO(&read_set);
+        FD_SET(listen_fd, &read_set);
+        int max_fd = listen_fd;
+
+        for (uint8_t i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0) {
+                FD_SET(clients[i].fd, &read_set);
+                if (clients[i].fd > max_fd) max_fd = clients[i].fd;
+            }
+        }
+
+        struct timeval tv;
+        tv.tv_sec = timeout_ms / 1000;
+        tv.tv_usec = (timeout_ms % 1000) * 1000;
+
+        if (select(max_fd + 1, &read_set, nullptr, nullptr, &tv) <= 0) return;
+
+        if (FD_ISSET(listen_fd, &read_set)) acceptClient();
+
+        for (uint8_t i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0 && FD_ISSET(clients[i].fd, &read_set)) {
+                serviceClient(clients[i]);
+            }
+        }
+    }
+
+    void stop() {
+        for (uint8_t i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0) closeClient(clients[i]);
+        }
+        if (listen_fd >= 0) {
+            close(listen_fd);
+            listen_fd = -1;
+        }
+    }
+
+    uint8_t getClientCount() const {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < MODBUS_TCP_MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0) count++;
+        }
+        return count;
+    }
+
+    uint16_t getPort() const {
+        return port;
+    }
+};
+
+// ==================== MODBUS TCP CLIENT ====================
+// ModbusMaster over Modbus TCP. All read/write calls, the async
+// submit()/update() API and ModbusPoller work unchanged; the slave
+// address argument becomes the MBAP unit identifier.
+//   ModbusTCPClient client;
+//   client.connect("192.168.1.50");
+//   client.readHoldingRegisters(1, 0, 10, regs);
+class ModbusTCPClient : public ModbusMaster {
+private:
+    int sock;
+    uint16_t transaction_id;
+    uint16_t rx_fill;
+    uint8_t frame[MODBUS_TCP_MBAP_SIZE + MODBUS_MAX_BUFFER];
+    uint8_t rx_frame[MODBUS_TCP_MBAP_SIZE + MODBUS_MAX_BUFFER];
+
+    // Pull the reply to the current transaction out of rx_frame, skipping
+    // late replies to earlier (timed out) transactions
+    bool extractADU(uint16_t& length) {
+        while (rx_fill >= MODBUS_TCP_MBAP_SIZE) {
+            uint16_t tid = ((uint16_t)rx_frame[0] << 8) | rx_frame[1];
+            uint16_t protocol = ((uint16_t)rx_frame[2] << 8) | rx_frame[3];
+            uint16_t adu_length = ((uint16_t)rx_frame[4] << 8) | rx_frame[5];
+
+            if (protocol != 0 || adu_length < 2 || adu_length > MODBUS_MAX_BUFFER) {
+                disconnect();
+                return false;
+            }
+
+            uint16_t total = 6 + adu_length;
+            if (rx_fill < total) return false;
+
+            bool match = (tid == transaction_id);
+            if (match) {
+                memcpy(rx_buffer, &rx_frame[6], adu_length);  // Unit + PDU
+                rx_length = adu_length;
+                length = adu_length;
+            }
+
+            memmove(rx_frame, rx_frame + total, rx_fill - total);
+            rx_fill -= total;
+
+            if (match) return true;
+        }
+        return false;
+    }
+
+    bool receiveSome(int flags) {
+        int n = recv(sock, rx_frame + rx_fill, sizeof(rx_frame) - rx_fill, flags);
+        if (n > 0) {
+            rx_fill += n;
+            return true;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) disconnect();
+        return false;
+    }
+
+protected:
+    void sendADU(uint16_t length) override {
+        if (sock < 0) return;
+
+        transaction_id++;
+        frame[0] = (transaction_id >> 8) & 0xFF;
+        frame[1] = transaction_id & 0xFF;
+        frame[2] = 0;
+        frame[3] = 0;
+        frame[4] = (length >> 8) & 0xFF;
+        frame[5] = length & 0xFF;
+        memcpy(&frame[6], tx_buffer, length);  // Unit + PDU
+
+        if (!modbus_tcp_send_all(sock, frame, 6 + length)) disconnect();
+    }
+
+    uint16_t receiveADU(uint32_t timeout) override {
+        uint32_t start_time = millis();
+        uint16_t length = 0;
+
+        while (sock >= 0) {
+            if (extractADU(length)) return length;
+
+            uint32_t elapsed = millis() - start_time;
+            if (elapsed >= timeout) break;
+
+            fd_set read_set;
+            FD_ZERO(&read_set);
+            FD_SET(sock, &read_set);
+
+            struct timeval tv;
+            tv.tv_sec = (timeout - elapsed) / 1000;
+            tv.tv_usec = ((timeout - elapsed) % 1000) * 1000;
+
+            if (select(sock + 1, &read_set, nullptr, nullptr, &tv) <= 0) break;
+            if (!receiveSome(0)) break;
+        }
+        return 0;
+    }
+
+    // TCP has no inter-frame gap
+    bool busReady() override {
+        return true;
+    }
+    
+    bool pollADU(uint16_t& length) override {
+        if (sock < 0) return false;
+        if (extractADU(length)) return true;
+        while (receiveSome(MSG_DONTWAIT)) {
+            if (extractADU(length)) return true;
+        }
+        return false;
+    }
+
+public:
+    explicit ModbusTCPClient(uint32_t timeout = MODBUS_DEFAULT_TIMEOUT)
+        : ModbusMaster(nullptr, timeout), sock(-1), transaction_id(0), rx_fill(0) {
+    }
+
+    ~ModbusTCPClient() {
+        disconnect();
+    }
+
+    bool connect(const char* ip, uint16_t port = MODBUS_TCP_PORT) {
+        disconnect();
+
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) return false;
+
+        sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (sock < 0) return false;
+
+        if (::connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            close(sock);
+            sock = -1;
+            return false;
+        }
+
+        modbus_tcp_set_nodelay(sock);
+        rx_fill = 0;
+        return true;
+    }
+
+    void disconnect() {
+        if (sock >= 0) {
+            close(sock);
+            sock = -1;
+        }
+        rx_fill = 0;
+    }
+
+    bool connected() const {
+        return sock >= 0;
+    }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef ARDULITEESP_PACKET_H
+#define ARDULITEESP_PACKET_H
+
+#include "ArduLiteESP_UART.h"
+#include "ArduLiteESP_COBS.h"
+
+#define PACKET_MAX_PAYLOAD                  128
+
+// ==================== UART PACKET ====================
+// Binary framed channel over a UART (see ArduLiteESP_COBS.h for the
+// frame format). Received chunks are decoded straight from the RX task's
+// bulk reads; each valid frame reaches the callback with its type byte.
+//   struct __attribute__((packed)) Sample { uint32_t time; int16_t ax, ay, az; };
+//   UARTPacket<> link(uart1);
+//   link.begin(921600, onPacket);
+//   link.send(1, sample);
+template<size_t MAX_PAYLOAD = PACKET_MAX_PAYLOAD>
+class UARTPacket {
+private:
+    UART& port;
+    PacketDecoder<MAX_PAYLOAD> decoder;
+
+public:
+    explicit UARTPacket(UART& uart) : port(uart) {}
+
+    void begin(uint32_t baud, PacketHandler callback,
+               int8_t tx_pin = -1, int8_t rx_pin = -1) {
+        decoder.setHandler(callback);
+        port.setReceiveHandler([this](const uint8_t* data, size_t length) {
+            decoder.feed(data, length);
+        });
+        port.begin(baud, nullptr, tx_pin, rx_pin);
+    }
+
+    // Encode on the stack and hand the frame to the driver in one write
+    bool send(uint8_t type, const void* payload, size_t length) {
+        if (length > MAX_PAYLOAD) return false;
+
+        uint8_t frame[COBS_MAX_ENCODED_SIZE(MAX_PAYLOAD + PACKET_OVERHEAD)];
+        size_t frame_length = packet_encode(type, payload, length, frame);
+        return port.write(frame, frame_length) == (int)frame_length;
+    }
+
+    template<typename T>
+    bool send(uint8_t type, const T& record) {
+        static_assert(sizeof(T) <= MAX_PAYLOAD, "Record larger than MAX_PAYLOAD");
+        return send(type, &record, sizeof(T));
+    }
+
+    template<typename T>
+    static bool read(const uint8_t* data, size_t length, T& record) {
+        return packet_read(data, length, record);
+    }
+
+    uint32_t getFrameCount() const {
+        return decoder.getFrameCount();
+    }
+
+    uint32_t getErrorCount() const {
+        return decoder.getErrorCount();
+    }
+};
+
+#endif
@@ -0,0 +1,419 @@
+#ifndef ARDULITEESP_POOL_H
+#define ARDULITEESP_POOL_H
+
+// Worker pool for splitting compute work (filters, CRCs, FFT stages)
+// across both ESP32 cores. One worker per core, each with its own deque:
+// a worker takes its newest item first and, when empty, steals the oldest
+// (largest) item from another worker. Ranges are split in half as they
+// run, so idle workers always find a big piece to steal.
+//
+//   WorkerPool pool;
+//   pool.begin();                                     // One worker per core
+//   pool.parallel_for(0, count, [&](size_t begin, size_t end) {
+//       for (size_t i = begin; i < end; i++) out[i] = filter(in[i]);
+//   });
+//
+//   WorkGroup group;                                  // Joinable handle
+//   pool.submit(group, [&]() { crc = crc32(log, size); });
+//   pool.submit(group, [&]() { fft(block); });
+//   group.wait();                                     // Waiter helps out
+//
+// Builds on a host with std::thread as well, for benchmarking.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+#include "ArduLiteESP_Callback.h"
+
+#ifdef ESP_PLATFORM
+  #include "freertos/FreeRTOS.h"
+  #include "freertos/task.h"
+  #include "freertos/semphr.h"
+  #define WORK_POOL_MAX_WORKERS             portNUM_PROCESSORS
+#else
+  #include <thread>
+  #include <mutex>
+  #include <condition_variable>
+  #define WORK_POOL_MAX_WORKERS             16
+#endif
+
+// Pool Settings
+#define WORK_QUEUE_SIZE                     32    // Items per worker deque
+#define WORK_POOL_TASK_STACK                4096
+#define WORK_POOL_TASK_PRIO                 1
+#define WORK_SPLITS_PER_WORKER              4     // Default grain: range / (workers * 4)
+
+using WorkFunction = Callback<void()>;
+using RangeFunction = Callback<void(size_t begin, size_t end)>;
+
+class WorkerPool;
+
+// ==================== PLATFORM ====================
+// Short critical section guarding one deque. On the ESP32 it masks
+// interrupts, so items are only moved while it is held: a callable's
+// copy and destructor run outside it, and its move should not allocate.
+class WorkLock {
+public:
+#ifdef ESP_PLATFORM
+    WorkLock() : mux(portMUX_INITIALIZER_UNLOCKED) {}
+    void lock() { portENTER_CRITICAL(&mux); }
+    void unlock() { portEXIT_CRITICAL(&mux); }
+private:
+    portMUX_TYPE mux;
+#else
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+private:
+    std::mutex mutex;
+#endif
+};
+
+// Binary wake-up flag: give() from any thread, take() blocks until given
+class WorkSignal {
+public:
+#ifdef ESP_PLATFORM
+    WorkSignal() : handle(xSemaphoreCreateBinaryStatic(&buffer)) {}
+    void give() { xSemaphoreGive(handle); }
+    void take() { xSemaphoreTake(handle, portMAX_DELAY); }
+private:
+    StaticSemaphore_t buffer;
+    SemaphoreHandle_t handle;
+#else
+    WorkSignal() : given(false) {}
+    void give() {
+        std::lock_guard<std::mutex> guard(mutex);
+        given = true;
+        condition.notify_one();
+    }
+    void take() {
+        std::unique_lock<std::mutex> guard(mutex);
+        condition.wait(guard, [this]() { return given; });
+        given = false;
+    }
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool given;
+#endif
+};
+
+// ==================== WORK GROUP ====================
+// Joinable handle for submitted work. wait() before reusing or
+// destroying it; run one parallel_for() at a time per group (any number
+// of submit()s).
+class WorkGroup {
+public:
+    WorkGroup() : pending(0), waiting(false), pool(nullptr), grain(1) {}
+
+    bool done() const {
+        return pending.load(std::memory_order_acquire) == 0;
+    }
+
+    // Runs queued items on the calling task, then blocks until the group
+    // completes
+    void wait();
+
+private:
+    friend class WorkerPool;
+
+    std::atomic<uint32_t> pending;
+    WorkLock lock;          // Orders the last completion against wait()
+    bool waiting;
+    WorkSignal finished;
+    WorkerPool* pool;
+    RangeFunction body;
+    size_t grain;
+
+    // Signal only a registered waiter, and only after the lock is
+    // released, so the group is never touched once wait() can return
+    void complete() {
+        lock.lock();
+        bool wake = pending.fetch_sub(1, std::memory_order_acq_rel) == 1 && waiting;
+        if (wake) waiting = false;
+        lock.unlock();
+        if (wake) finished.give();
+    }
+};
+
+// ==================== WORKER POOL ====================
+class WorkerPool {
+public:
+    WorkerPool() : worker_count(0), queued(0), next_home(0), stopping(false), running(0) {}
+
+    ~WorkerPool() {
+        end();
+    }
+
+    // `workers` 0 = one per core (hardware threads on a host)
+    bool begin(uint8_t workers = 0, uint8_t priority = WORK_POOL_TASK_PRIO,
+               uint32_t stack_size = WORK_POOL_TASK_STACK) {
+        if (worker_count) return false;
+#ifdef ESP_PLATFORM
+        if (workers == 0) workers = portNUM_PROCESSORS;
+#else
+        if (workers == 0) workers = (uint8_t)std::thread::hardware_concurrency();
+        if (workers == 0) workers = 1;
+        (void)priority;
+        (void)stack_size;
+#endif
+        if (workers > WORK_POOL_MAX_WORKERS) workers = WORK_POOL_MAX_WORKERS;
+
+        stopping.store(false);
+        worker_count = workers;
+        for (uint8_t i = 0; i < workers; i++) {
+            Start* start = &starts[i];
+            start->pool = this;
+            start->index = i;
+            running++;
+#ifdef ESP_PLATFORM
+            if (xTaskCreatePinnedToCore(worker_entry, "work", stack_size, start, priority,
+                                        nullptr, i % portNUM_PROCESSORS) != pdPASS) {
+                running--;
+            }
+#else
+            threads[i] = std::thread(worker_entry, start);
+#endif
+        }
+        return running.load() == workers;
+    }
+
+    // Workers finish their current item and exit; wait() for outstanding
+    // groups first, queued items are dropped
+    void end() {
+        if (!worker_count) return;
+        stopping.store(true);
+        for (uint8_t i = 0; i < worker_count; i++) workers[i].signal.give();
+#ifdef ESP_PLATFORM
+        while (running.load() > 0) vTaskDelay(1);
+#else
+        for (uint8_t i = 0; i < worker_count; i++) threads[i].join();
+#endif
+        worker_count = 0;
+    }
+
+    uint8_t getWorkerCount() const {
+        return worker_count;
+    }
+
+    // Queue `function`; runs it on the caller when the deque is full
+    void submit(WorkGroup& group, WorkFunction function) {
+        group.pool = this;
+        WorkItem item;
+        item.group = &group;
+        item.begin = item.end = 0;
+        item.function = function;
+        group.pending.fetch_add(1);
+        if (!push(nextHome(), item)) execute(item, nextHome());
+    }
+
+    // Call body(begin, end) over sub-ranges of [begin, end) of at most
+    // `grain` items (0 = automatic) and return without waiting; join with
+    // group.wait(). `body` is kept in the group.
+    void parallel_for(WorkGroup& group, size_t begin, size_t end, RangeFunction body, size_t grain = 0) {
+        if (end <= begin) return;
+        size_t count = end - begin;
+        size_t shares = worker_count ? worker_count : 1;
+        if (grain == 0) grain = count / (shares * WORK_SPLITS_PER_WORKER);
+        if (grain == 0) grain = 1;
+
+        group.pool = this;
+        group.body = body;
+        group.grain = grain;
+
+        // One share per deque to start with; stealing balances the rest
+        if (count < shares * grain) shares = (count + grain - 1) / grain;
+        for (size_t i = 0; i < shares; i++) {
+            WorkItem item;
+            item.group = &group;
+            item.begin = begin + count * i / shares;
+            item.end = begin + count * (i + 1) / shares;
+            group.pending.fetch_add(1);
+            if (!push((uint8_t)i, item)) execute(item, nextHome());
+        }
+    }
+
+    // Blocking form: the caller works alongside the pool
+    void parallel_for(size_t begin, size_t end, RangeFunction body, size_t grain = 0) {
+        WorkGroup group;
+        parallel_for(group, begin, end, body, grain);
+        group.wait();
+    }
+
+private:
+    friend class WorkGroup;
+
+    struct WorkItem {
+        WorkGroup* group;
+        size_t begin;
+        size_t end;
+        WorkFunction function;      // Empty for a parallel_for range
+    };
+
+    // Owner pushes and pops at `bottom`; thieves take from `top`
+    struct Worker {
+        WorkLock lock;
+        WorkSignal signal;
+        std::atomic<bool> idle;
+        uint32_t top;
+        uint32_t bottom;
+        WorkItem items[WORK_QUEUE_SIZE];
+
+        Worker() : idle(false), top(0), bottom(0) {}
+    };
+
+    struct Start {
+        WorkerPool* pool;
+        uint8_t index;
+    };
+
+    Worker workers[WORK_POOL_MAX_WORKERS];
+    Start starts[WORK_POOL_MAX_WORKERS];
+#ifndef ESP_PLATFORM
+    std::thread threads[WORK_POOL_MAX_WORKERS];
+#endif
+    uint8_t worker_count;
+    std::atomic<uint32_t> queued;
+    std::atomic<uint32_t> next_home;
+    std::atomic<bool> stopping;
+    std::atomic<uint8_t> running;
+
+    uint8_t nextHome() {
+        return worker_count ? (uint8_t)(next_home.fetch_add(1, std::memory_order_relaxed) % worker_count) : 0;
+    }
+
+    // Moves `item` into the deque; left as it was when full
+    bool push(uint8_t index, WorkItem& item) {
+        if (index >= worker_count) return false;
+        Worker& worker = workers[index];
+
+        worker.lock.lock();
+        bool full = worker.bottom - worker.top == WORK_QUEUE_SIZE;
+        if (!full) {
+            worker.items[worker.bottom % WORK_QUEUE_SIZE] = std::move(item);
+            worker.bottom++;
+        }
+        worker.lock.unlock();
+        if (full) return false;
+
+        queued.fetch_add(1);
+        wakeOne();
+        return true;
+    }
+
+    bool popLocal(uint8_t index, WorkItem& item) {
+        Worker& worker = workers[index];
+        item.function = nullptr;    // Destroy the previous callable unlocked
+        worker.lock.lock();
+        bool found = worker.bottom != worker.top;
+        if (found) {
+            worker.bottom--;
+            item = std::move(worker.items[worker.bottom % WORK_QUEUE_SIZE]);
+        }
+        worker.lock.unlock();
+        if (found) queued.fetch_sub(1);
+        return found;
+    }
+
+    // Oldest item of the first non-empty deque after `from`
+    bool steal(uint8_t from, WorkItem& item) {
+        item.function = nullptr;
+        for (uint8_t n = 1; n <= worker_count; n++) {
+            if (queued.load() == 0) return false;
+            Worker& victim = workers[(from + n) % worker_count];
+            victim.lock.lock();
+            bool found = victim.bottom != victim.top;
+            if (found) {
+                item = std::move(victim.items[victim.top % WORK_QUEUE_SIZE]);
+                victim.top++;
+            }
+            victim.lock.unlock();
+            if (found) {
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void wakeOne() {
+        for (uint8_t i = 0; i < worker_count; i++) {
+            if (workers[i].idle.load() && workers[i].idle.exchange(false)) {
+                workers[i].signal.give();
+                return;
+            }
+        }
+    }
+
+    // Split a range while it is larger than the grain, leaving the upper
+    // halves on `home` for its worker or for thieves
+    void execute(WorkItem& item, uint8_t home) {
+        WorkGroup* group = item.group;
+
+        if (item.function) {
+            item.function();
+        } else {
+            size_t begin = item.begin;
+            size_t end = item.end;
+            while (end - begin > group->grain) {
+                WorkItem upper;
+                upper.group = group;
+                upper.begin = begin + (end - begin) / 2;
+                upper.end = end;
+                group->pending.fetch_add(1);
+                if (!push(home, upper)) {
+                    group->pending.fetch_sub(1);
+                    break;  // Deque full: run the rest here
+                }
+                end = upper.begin;
+            }
+            group->body(begin, end);
+        }
+
+        group->complete();
+    }
+
+    void work(uint8_t index) {
+        Worker& self = workers[index];
+        WorkItem item;
+
+        while (!stopping.load()) {
+            if (popLocal(index, item) || steal(index, item)) {
+                execute(item, index);
+                continue;
+            }
+
+            // Announce idle, then re-check so a concurrent push is not missed
+            self.idle.store(true);
+            if (queued.load() != 0 || stopping.load()) {
+                if (!self.idle.exchange(false)) self.signal.take();  // Already woken
+                continue;
+            }
+            self.signal.take();
+        }
+        running--;
+    }
+
+    static void worker_entry(void* param) {
+        Start* start = (Start*)param;
+        start->pool->work(start->index);
+#ifdef ESP_PLATFORM
+        vTaskDelete(nullptr);
+#endif
+    }
+};
+
+inline void WorkGroup::wait() {
+    WorkerPool::WorkItem item;
+    while (!done() && pool && pool->steal(0, item)) {
+        pool->execute(item, pool->nextHome());
+    }
+
+    lock.lock();
+    bool complete = pending.load(std::memory_order_acquire) == 0;
+    if (!complete) waiting = true;
+    lock.unlock();
+    if (!complete) finished.take();
+}
+
+#endif
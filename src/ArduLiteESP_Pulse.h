@@ -2,6 +2,9 @@
 #define ARDULITEESP_PULSE_H
 
 #include "ArduLiteESP_Core.h"
+#include "ArduLiteESP_Ring.h"
+
+#define PULSE_CAPTURE_QUEUE_SIZE            32    // Edges, power of two
 
 class Pulse {
 public:
@@ -99,4 +102,136 @@ private:
     }
 };
 
+struct PulseEdge {
+    uint32_t time_us;
+    bool level;         // Level after the edge
+};
+
+// Interrupt-driven pulse measurement. The GPIO ISR timestamps every edge
+// into a lock-free SPSCRing, so read() returns finished pulses without
+// busy-waiting and nothing is missed while the task does other work.
+class PulseCapture {
+public:
+    explicit PulseCapture(uint8_t pin, uint8_t mode = IN)
+        : pin_num(pin),
+          overflow_count(0),
+          rise_time(0),
+          fall_time(0),
+          has_rise(false),
+          has_fall(false),
+          attached(false) {
+
+        if (pin > 39) return;
+
+        uint32_t mask32 = 1UL << (pin % 32);
+        if (pin < 32) GPIO.enable_w1tc = mask32;
+        else GPIO.enable1_w1tc.val = mask32;
+
+        gpio_pullup_dis((gpio_num_t)pin);
+        gpio_pulldown_dis((gpio_num_t)pin);
+
+        if (mode == IN_PULLUP)
+            gpio_pullup_en((gpio_num_t)pin);
+        else if (mode == IN_PULLDOWN)
+            gpio_pulldown_en((gpio_num_t)pin);
+    }
+
+    ~PulseCapture() {
+        end();
+    }
+
+    // The ISR holds a pointer to this object
+    PulseCapture(const PulseCapture&) = delete;
+    PulseCapture& operator=(const PulseCapture&) = delete;
+
+    bool begin() {
+        if (pin_num > 39) return false;
+        if (attached) return true;
+
+        // The shared GPIO ISR service may already be installed by another user
+        esp_err_t err = gpio_install_isr_service(0);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) return false;
+
+        gpio_set_intr_type((gpio_num_t)pin_num, GPIO_INTR_ANYEDGE);
+        if (gpio_isr_handler_add((gpio_num_t)pin_num, isr, this) != ESP_OK) return false;
+        attached = true;
+
+        if (gpio_intr_enable((gpio_num_t)pin_num) != ESP_OK) {
+            end();
+            return false;
+        }
+        return true;
+    }
+
+    // Only detaches a handler this object installed
+    void end() {
+        if (!attached) return;
+        gpio_intr_disable((gpio_num_t)pin_num);
+        gpio_isr_handler_remove((gpio_num_t)pin_num);
+        attached = false;
+    }
+
+    // Width of the next finished high pulse in microseconds, 0 if none
+    uint32_t read() {
+        return next(true);
+    }
+
+    // Width of the next finished low pulse in microseconds, 0 if none
+    uint32_t readLow() {
+        return next(false);
+    }
+
+    // Raw edges, oldest first
+    bool readEdge(PulseEdge &edge) {
+        return edges.pop(edge);
+    }
+
+    size_t available() {
+        return edges.available();
+    }
+
+    // Edges lost because the queue was full
+    uint32_t getOverflowCount() const {
+        return overflow_count;
+    }
+
+private:
+    uint8_t pin_num;
+    SPSCRing<PulseEdge, PULSE_CAPTURE_QUEUE_SIZE> edges;
+    volatile uint32_t overflow_count;
+    uint32_t rise_time;
+    uint32_t fall_time;
+    bool has_rise;
+    bool has_fall;
+    bool attached;
+
+    // Runs while the flash cache may be disabled
+    static void IRAM_ATTR isr(void *arg) {
+        PulseCapture *self = (PulseCapture*)arg;
+        PulseEdge edge;
+        edge.time_us = (uint32_t)esp_timer_get_time();
+        edge.level = (self->pin_num < 32) ? (GPIO.in >> self->pin_num) & 1U
+                                          : (GPIO.in1.val >> (self->pin_num - 32)) & 1U;
+        if (!self->edges.push(edge)) self->overflow_count++;
+    }
+
+    uint32_t next(bool high) {
+        PulseEdge edge;
+        while (edges.pop(edge)) {
+            if (edge.level) {
+                bool done = !high && has_fall;
+                rise_time = edge.time_us;
+                has_rise = true;
+                if (done) return rise_time - fall_time;
+            } else {
+                bool done = high && has_rise;
+                fall_time = edge.time_us;
+                has_fall = true;
+                if (done) return fall_time - rise_time;
+            }
+        }
+        return 0;
+    }
+};
+
 #endif
@@ -0,0 +1,202 @@
+#ifndef ARDULITEESP_RING_H
+#define ARDULITEESP_RING_H
+
+// Lock-free ring buffers for ISR-to-task and task-to-task (or
+// core-to-core) data. Neither takes a lock or a critical section, so
+// both are safe to use from an ISR. Only the C++ standard library is
+// needed, so they build and can be benchmarked on a host.
+//
+//   SPSCRing<T, N>  one producer, one consumer
+//   MPSCRing<T, N>  any number of producers, one consumer
+//
+// N must be a power of two. SPSCRing holds up to N items and MPSCRing
+// exactly N.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#ifndef RING_CACHE_LINE
+  #ifdef ESP_PLATFORM
+    #define RING_CACHE_LINE                 32
+  #else
+    #define RING_CACHE_LINE                 64
+  #endif
+#endif
+
+// ==================== SPSC RING ====================
+// The producer only writes `head` and the consumer only writes `tail`;
+// each keeps a private copy of the other's index and only reloads it
+// when the ring looks full/empty, so the shared lines are touched as
+// little as possible.
+template<typename T, size_t N>
+class SPSCRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SPSCRing size must be a power of two");
+
+private:
+    inline static constexpr size_t MASK = N - 1;
+
+    alignas(RING_CACHE_LINE) std::atomic<size_t> head;  // Next write, owned by the producer
+    size_t cached_tail;
+    alignas(RING_CACHE_LINE) std::atomic<size_t> tail;  // Next read, owned by the consumer
+    size_t cached_head;
+    alignas(RING_CACHE_LINE) T items[N];
+
+    // Bulk copies run in at most two contiguous pieces around the wrap
+    void copyIn(size_t start, const T* data, size_t count) {
+        size_t first = N - start < count ? N - start : count;
+        for (size_t i = 0; i < first; i++) items[start + i] = data[i];
+        for (size_t i = first; i < count; i++) items[i - first] = data[i];
+    }
+
+    void copyOut(size_t start, T* data, size_t count) const {
+        size_t first = N - start < count ? N - start : count;
+        for (size_t i = 0; i < first; i++) data[i] = items[start + i];
+        for (size_t i = first; i < count; i++) data[i] = items[i - first];
+    }
+
+public:
+    SPSCRing() : head(0), cached_tail(0), tail(0), cached_head(0) {}
+
+    // ---- Producer side ----
+
+    bool push(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - cached_tail == N) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h - cached_tail == N) return false;
+        }
+        items[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Copy up to `count` items and publish them together; returns the
+    // number written
+    size_t write(const T* data, size_t count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t free_items = N - (h - cached_tail);
+        if (free_items < count) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            free_items = N - (h - cached_tail);
+        }
+        if (count > free_items) count = free_items;
+
+        copyIn(h & MASK, data, count);
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t space() {
+        cached_tail = tail.load(std::memory_order_acquire);
+        return N - (head.load(std::memory_order_relaxed) - cached_tail);
+    }
+
+    // ---- Consumer side ----
+
+    bool pop(T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == cached_head) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t == cached_head) return false;
+        }
+        item = items[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t read(T* data, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t used = cached_head - t;
+        if (used < count) {
+            cached_head = head.load(std::memory_order_acquire);
+            used = cached_head - t;
+        }
+        if (count > used) count = used;
+
+        copyOut(t & MASK, data, count);
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t available() {
+        cached_head = head.load(std::memory_order_acquire);
+        return cached_head - tail.load(std::memory_order_relaxed);
+    }
+
+    bool empty() {
+        return available() == 0;
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+};
+
+// ==================== MPSC RING ====================
+// Bounded multi-producer queue (Vyukov): a producer claims a slot with a
+// CAS on `head`, fills it, then publishes it through the slot's sequence
+// number. A producer interrupted between claim and publish only delays
+// the consumer at that slot; it never corrupts the ring.
+template<typename T, size_t N>
+class MPSCRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MPSCRing size must be a power of two");
+
+private:
+    inline static constexpr uint32_t MASK = N - 1;
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        T item;
+    };
+
+    alignas(RING_CACHE_LINE) std::atomic<uint32_t> head;
+    alignas(RING_CACHE_LINE) uint32_t tail;
+    alignas(RING_CACHE_LINE) Slot slots[N];
+
+public:
+    MPSCRing() : head(0), tail(0) {
+        for (uint32_t i = 0; i < N; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Any task, core or ISR; false when the ring is full
+    bool push(const T& item) {
+        uint32_t position = head.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true) {
+            slot = &slots[position & MASK];
+            int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - position);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->item = item;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Single consumer only
+    bool pop(T& item) {
+        Slot& slot = slots[tail & MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) return false;
+
+        item = slot.item;
+        slot.sequence.store(tail + N, std::memory_order_release);
+        tail++;
+        return true;
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+};
+
+#endif
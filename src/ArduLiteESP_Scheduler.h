@@ -0,0 +1,321 @@
+#ifndef ARDULITEESP_SCHEDULER_H
+#define ARDULITEESP_SCHEDULER_H
+
+// Cooperative jobs: many small behaviours sharing one FreeRTOS task.
+// A Job is a stackless protothread - run() is re-entered at the point
+// where it last waited, so a job costs its own members plus ~24 bytes
+// instead of a task stack.
+//
+//   class Blink : public Job {
+//       LED& led; uint32_t ms;
+//   public:
+//       Blink(LED& l, uint32_t period) : led(l), ms(period) {}
+//       void run() override {
+//           JOB_BEGIN();
+//           forever() {
+//               led.toggle();
+//               JOB_SLEEP(ms);
+//           }
+//           JOB_END();
+//       }
+//   };
+//
+//   Scheduler scheduler;
+//   Blink fast(led1, 100), slow(led2, 700);
+//   scheduler.add(fast);
+//   scheduler.add(slow);
+//   scheduler.begin();                    // One task runs every job
+//
+// Rules of a job body: local variables do not survive a JOB_ macro (keep
+// state in members), at most one JOB_ macro per source line (the line
+// number is the resume point), and no JOB_ macro inside a `switch`.
+// Jobs are added and removed from the scheduler's own task only (before
+// begin(), or by other jobs). Other tasks and ISRs call notify() after
+// changing something a JOB_WAIT_UNTIL() condition depends on.
+
+#include "ArduLiteESP_Core.h"
+#include "ArduLiteESP_Task.h"
+
+// Scheduler Settings
+#ifndef SCHEDULER_MAX_JOBS
+  #define SCHEDULER_MAX_JOBS                64    // Scheduled at once, 4 bytes each
+#endif
+#define SCHEDULER_POLL_MS                   10    // Re-check of JOB_WAIT_UNTIL conditions
+#define SCHEDULER_IDLE_MS                   100   // Nothing scheduled at all
+#define SCHEDULER_TASK_STACK                4096
+#define SCHEDULER_TASK_PRIO                 1
+
+// ==================== JOB MACROS ====================
+#define JOB_BEGIN()                 switch (job_line) { case 0:
+#define JOB_END()                   } finish(); return
+
+// Let every other ready job run first
+#define JOB_YIELD() \
+    do { job_line = __LINE__; pollNext(); return; case __LINE__:; } while (0)
+
+#define JOB_SLEEP(ms) \
+    do { job_line = __LINE__; sleepFor(ms); return; case __LINE__:; } while (0)
+
+// Re-evaluated every SCHEDULER_POLL_MS until true, and at once after
+// Scheduler::notify()
+#define JOB_WAIT_UNTIL(condition) \
+    do { job_line = __LINE__; [[fallthrough]]; case __LINE__: if (!(condition)) { pollNext(); return; } } while (0)
+
+#define JOB_WAIT_PRESSED(button)            JOB_WAIT_UNTIL((button).pressed())
+
+// Needs a line queue on the port (UART::setLineQueue)
+#define JOB_WAIT_LINE(port, line, size)     JOB_WAIT_UNTIL((port).readLine((line), (size)))
+
+// ==================== JOB ====================
+class Job {
+public:
+    Job() : job_line(0), next(nullptr), wake_ms(0), sleep_order(0), heap_index(0), state(IDLE) {}
+    virtual ~Job() {}
+
+    // Body between JOB_BEGIN() and JOB_END()
+    virtual void run() = 0;
+
+    bool scheduled() const {
+        return state != IDLE;
+    }
+
+protected:
+    uint16_t job_line;      // Resume point, 0 = start
+
+    void sleepFor(uint32_t ms) {
+        if (ms == 0) {
+            pollNext();
+            return;
+        }
+        wake_ms = millis() + ms;
+        state = SLEEPING;
+    }
+
+    void pollNext() {
+        state = POLLING;
+    }
+
+    void finish() {
+        job_line = 0;
+        state = IDLE;
+    }
+
+private:
+    friend class Scheduler;
+
+    enum State : uint8_t { IDLE, RUNNING, SLEEPING, POLLING };
+
+    Job* next;
+    uint32_t wake_ms;
+    uint32_t sleep_order;   // Ties on wake_ms wake in sleep order
+    uint16_t heap_index;
+    State state;
+};
+
+// ==================== SCHEDULER ====================
+// Sleeping jobs wait in a binary min-heap on wake time, so a pass only
+// looks at the jobs that are due and a sleep costs O(log n); jobs waiting
+// on a condition are polled.
+class Scheduler {
+public:
+    Scheduler()
+        : sleeping_count(0), sleep_order(0), polling(nullptr), polling_tail(nullptr), pending(nullptr),
+          current(nullptr), job_count(0), task_handle(nullptr) {}
+
+    // (Re)start `job` from JOB_BEGIN() on the next pass; false if it is
+    // already scheduled or SCHEDULER_MAX_JOBS are
+    bool add(Job& job) {
+        if (job.state != Job::IDLE) return false;
+        if (&job == current) {
+            // Removed and re-added while running
+            job.job_line = 0;
+            job.state = Job::POLLING;
+            return true;
+        }
+        if (job_count >= SCHEDULER_MAX_JOBS) return false;
+        job.job_line = 0;
+        job.state = Job::POLLING;
+        appendPolling(&job);
+        job_count++;
+        return true;
+    }
+
+    void remove(Job& job) {
+        if (job.state == Job::IDLE) return;
+        if (&job != current) {
+            if (job.state == Job::SLEEPING) removeSleeping(job.heap_index);
+            else if (!unlink(polling, &job)) unlink(pending, &job);
+            job_count--;
+        }
+        job.state = Job::IDLE;  // The running job is dropped when it returns
+    }
+
+    // Run the scheduler in its own task
+    void begin(const char* name = "jobs", uint32_t stack_size = SCHEDULER_TASK_STACK,
+               uint8_t priority = SCHEDULER_TASK_PRIO) {
+        Task([this]() { run(); }, name, stack_size, priority);
+    }
+
+    // Or call it from an existing task; never returns
+    void run() {
+        task_handle = xTaskGetCurrentTaskHandle();
+        forever() {
+            uint32_t ms = runOnce();
+            if (ms == UINT32_MAX) ms = SCHEDULER_IDLE_MS;
+            TickType_t ticks = pdMS_TO_TICKS(ms);
+            ulTaskNotifyTake(pdTRUE, ticks ? ticks : 1);  // notify() ends the wait early
+        }
+    }
+
+    // Start a pass now instead of at the next poll, so JOB_WAIT_UNTIL()
+    // sees a change without waiting up to SCHEDULER_POLL_MS. Any task.
+    void notify() {
+        if (task_handle) xTaskNotifyGive(task_handle);
+    }
+
+    void notifyFromISR() {
+        if (!task_handle) return;
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task_handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+
+    // One pass over the due jobs; returns the ms until another pass is
+    // needed, UINT32_MAX if nothing is scheduled
+    uint32_t runOnce() {
+        uint32_t now = millis();
+
+        // Detach first, so a job that waits again is polled next pass
+        pending = polling;
+        polling = polling_tail = nullptr;
+
+        // A job sleeps at least 1 ms, so it cannot be due twice in one pass
+        while (sleeping_count && (int32_t)(sleeping[0]->wake_ms - now) <= 0) {
+            Job* job = sleeping[0];
+            removeSleeping(0);
+            dispatch(job);
+        }
+
+        while (pending) {
+            Job* job = pending;
+            pending = job->next;
+            dispatch(job);
+        }
+
+        uint32_t wait_ms = polling ? SCHEDULER_POLL_MS : UINT32_MAX;
+        if (sleeping_count) {
+            int32_t until = (int32_t)(sleeping[0]->wake_ms - millis());
+            uint32_t sleep_ms = until > 0 ? (uint32_t)until : 0;
+            if (sleep_ms < wait_ms) wait_ms = sleep_ms;
+        }
+        return wait_ms;
+    }
+
+    uint32_t getJobCount() const {
+        return job_count;
+    }
+
+private:
+    Job* sleeping[SCHEDULER_MAX_JOBS];  // Min-heap on (wake_ms, sleep_order)
+    uint16_t sleeping_count;
+    uint32_t sleep_order;
+    Job* polling;           // Run order
+    Job* polling_tail;
+    Job* pending;           // Polled jobs still to run in this pass
+    Job* current;
+    uint32_t job_count;
+    TaskHandle_t task_handle;
+
+    void dispatch(Job* job) {
+        job->next = nullptr;
+        job->state = Job::RUNNING;
+        current = job;
+        job->run();
+        current = nullptr;
+
+        switch (job->state) {
+            case Job::SLEEPING:
+                insertSleeping(job);
+                break;
+            case Job::IDLE:
+                job_count--;  // Finished or removed
+                break;
+            default:
+                // Returned without a JOB_ macro: treat as a yield
+                job->state = Job::POLLING;
+                appendPolling(job);
+                break;
+        }
+    }
+
+    void appendPolling(Job* job) {
+        job->next = nullptr;
+        if (polling_tail) polling_tail->next = job;
+        else polling = job;
+        polling_tail = job;
+    }
+
+    static bool wakesBefore(const Job* a, const Job* b) {
+        int32_t diff = (int32_t)(a->wake_ms - b->wake_ms);
+        return diff < 0 || (diff == 0 && (int32_t)(a->sleep_order - b->sleep_order) < 0);
+    }
+
+    void place(Job* job, uint16_t index) {
+        sleeping[index] = job;
+        job->heap_index = index;
+    }
+
+    void siftUp(uint16_t index) {
+        Job* job = sleeping[index];
+        while (index > 0) {
+            uint16_t parent = (index - 1) / 2;
+            if (!wakesBefore(job, sleeping[parent])) break;
+            place(sleeping[parent], index);
+            index = parent;
+        }
+        place(job, index);
+    }
+
+    void siftDown(uint16_t index) {
+        Job* job = sleeping[index];
+        forever() {
+            uint16_t child = 2 * index + 1;
+            if (child >= sleeping_count) break;
+            if (child + 1 < sleeping_count && wakesBefore(sleeping[child + 1], sleeping[child])) child++;
+            if (!wakesBefore(sleeping[child], job)) break;
+            place(sleeping[child], index);
+            index = child;
+        }
+        place(job, index);
+    }
+
+    // Room is guaranteed: every sleeping job counts against SCHEDULER_MAX_JOBS
+    void insertSleeping(Job* job) {
+        job->sleep_order = sleep_order++;
+        place(job, sleeping_count++);
+        siftUp(job->heap_index);
+    }
+
+    void removeSleeping(uint16_t index) {
+        Job* last = sleeping[--sleeping_count];
+        if (index == sleeping_count) return;
+        place(last, index);
+        siftUp(index);
+        siftDown(last->heap_index);
+    }
+
+    bool unlink(Job*& head, Job* job) {
+        Job* previous = nullptr;
+        for (Job** link = &head; *link; link = &(*link)->next) {
+            if (*link == job) {
+                *link = job->next;
+                if (polling_tail == job) polling_tail = previous;
+                return true;
+            }
+            previous = *link;
+        }
+        return false;
+    }
+};
+
+#endif
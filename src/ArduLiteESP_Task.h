@@ -2,54 +2,401 @@
 #define ARDULITEESP_TASK_H
 
 #include "ArduLiteESP_Core.h"
+#include "ArduLiteESP_Callback.h"
+#include "freertos/semphr.h"
+
+// PeriodicTask Settings
+#define PERIODIC_JITTER_BINS                16    // Bin n counts |jitter| < 2^n us
+#define PERIODIC_TASK_STACK                 2048
+
+// Task body: a plain function or a lambda with up to CALLBACK_CAPACITY
+// bytes of captures, e.g. [&led, ms]() { forever() { led.toggle(); wait(ms); } }
+// Capture by value anything that does not outlive the task.
+typedef Callback<void()> TaskFunction;
 
 class Task {
 public:
-    Task(void (*func)(), const char* name) {
-        create(func, name, 2048, 1);
+    Task(TaskFunction func, const char* name) {
+        create(func, name, 2048, 1, tskNO_AFFINITY);
     }
 
-    Task(void (*func)(), const char* name, uint32_t stack_size) {
-        create(func, name, stack_size, 1);
+    Task(TaskFunction func, const char* name, uint32_t stack_size) {
+        create(func, name, stack_size, 1, tskNO_AFFINITY);
     }
 
-    Task(void (*func)(), const char* name,
+    Task(TaskFunction func, const char* name,
          uint32_t stack_size, uint8_t priority) {
-        create(func, name, stack_size, priority);
+        create(func, name, stack_size, priority, tskNO_AFFINITY);
     }
 
-    Task(void (*func)(), const char* name,
+    Task(TaskFunction func, const char* name,
          uint32_t stack_size, uint8_t priority, uint8_t core) {
-
-        xTaskCreatePinnedToCore(
-            task_entry,
-            name,
-            stack_size,
-            (void*)func,
-            priority,
-            nullptr,
-            core
-        );
+        create(func, name, stack_size, priority, core);
     }
 
 private:
+    // Lives on the creator's stack until the new task has copied `func`
+    // onto its own, so a Task can be a temporary and nothing is allocated
+    struct Start {
+        TaskFunction func;
+        SemaphoreHandle_t copied;
+        StaticSemaphore_t copied_buffer;
+    };
+
     static void task_entry(void* param) {
-        void (*f)() = (void (*)())param;
+        Start* start = (Start*)param;
+        TaskFunction f = start->func;
+        xSemaphoreGive(start->copied);
         f();
         vTaskDelete(nullptr);
     }
 
-    static void create(void (*func)(), const char* name,
-                       uint32_t stack_size, uint8_t priority) {
+    static void create(const TaskFunction& func, const char* name,
+                       uint32_t stack_size, uint8_t priority, BaseType_t core) {
+        Start start;
+        start.func = func;
+        start.copied = xSemaphoreCreateBinaryStatic(&start.copied_buffer);
+
+        if (xTaskCreatePinnedToCore(
+                task_entry,
+                name,
+                stack_size,
+                &start,
+                priority,
+                nullptr,
+                core) == pdPASS) {
+            xSemaphoreTake(start.copied, portMAX_DELAY);
+        }
+        vSemaphoreDelete(start.copied);
+    }
+};
+
+// ==================== STATIC TASK ====================
+// Task whose TCB and stack live inside the object (no heap), sized at
+// compile time. Unlike Task it keeps the handle, so stack use, CPU time,
+// suspend/resume and notifications are available.
+//   StaticTask<3072> sensor(sensorLoop, "sensor", 2);
+//   uart.sendLine(sensor.stackHighWater());
+// STACK_SIZE is in bytes, the unit ESP-IDF uses for all task stacks.
+// The object must outlive the task, so declare it global or static.
+template<uint32_t STACK_SIZE = 2048>
+class StaticTask {
+public:
+    StaticTask() : handle(nullptr), func(nullptr), runtime_last(0), runtime_total(0) {}
+
+    StaticTask(TaskFunction task_func, const char* name,
+               uint8_t priority = 1, int8_t core = -1)
+        : StaticTask() {
+        start(task_func, name, priority, core);
+    }
+
+    ~StaticTask() {
+        stop();
+    }
+
+    // The running task points at this object's TCB and stack
+    StaticTask(const StaticTask&) = delete;
+    StaticTask& operator=(const StaticTask&) = delete;
 
-        xTaskCreate(
+    // `core` -1 lets the scheduler pick; false if already running
+    bool start(TaskFunction task_func, const char* name,
+               uint8_t priority = 1, int8_t core = -1) {
+        if (handle) return false;
+
+        func = task_func;
+        runtime_last = 0;
+        runtime_total = 0;
+        handle = xTaskCreateStaticPinnedToCore(
             task_entry,
             name,
-            stack_size,
-            (void*)func,
+            STACK_SIZE / sizeof(StackType_t),
+            this,
             priority,
-            nullptr
+            stack,
+            &tcb,
+            core < 0 ? tskNO_AFFINITY : (BaseType_t)core
         );
+        return handle != nullptr;
+    }
+
+    void stop() {
+        if (handle) {
+            TaskHandle_t h = handle;
+            handle = nullptr;
+            vTaskDelete(h);
+        }
+    }
+
+    bool running() const {
+        return handle != nullptr;
+    }
+
+    TaskHandle_t getHandle() const {
+        return handle;
+    }
+
+    // Smallest amount of stack (bytes) that has stayed free so far
+    uint32_t stackHighWater() const {
+        return handle ? uxTaskGetStackHighWaterMark(handle) : 0;
+    }
+
+    static constexpr uint32_t stackSize() {
+        return STACK_SIZE;
+    }
+
+    // CPU time consumed by the task. Needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    // and CONFIG_FREERTOS_USE_TRACE_FACILITY; otherwise 0. ESP-IDF's run time
+    // clock is esp_timer, i.e. microseconds. FreeRTOS keeps a 32-bit
+    // counter that wraps after ~71 minutes of CPU time; it is extended to
+    // 64 bits here, which stays exact as long as this is called at least
+    // once per wrap, from one task at a time.
+    uint64_t runtimeUs() const {
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+        if (!handle) return 0;
+        TaskStatus_t status;
+        vTaskGetInfo(handle, &status, pdFALSE, eInvalid);
+        runtime_total += (uint32_t)(status.ulRunTimeCounter - runtime_last);
+        runtime_last = status.ulRunTimeCounter;
+        return runtime_total;
+#else
+        return 0;
+#endif
+    }
+
+    void suspend() {
+        if (handle) vTaskSuspend(handle);
+    }
+
+    void resume() {
+        if (handle) vTaskResume(handle);
+    }
+
+    void notify() {
+        if (handle) xTaskNotifyGive(handle);
+    }
+
+    void notifyFromISR() {
+        if (!handle) return;
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+
+    // Called from inside the task: block until notify(); returns the
+    // number of notifications taken (0 on timeout)
+    static uint32_t waitNotify(uint32_t timeout_ms = portMAX_DELAY) {
+        TickType_t ticks = (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+        return ulTaskNotifyTake(pdTRUE, ticks);
+    }
+
+private:
+    TaskHandle_t handle;
+    TaskFunction func;
+    mutable uint32_t runtime_last;   // Counter value at the previous runtimeUs()
+    mutable uint64_t runtime_total;
+    StaticTask_t tcb;
+    StackType_t stack[STACK_SIZE / sizeof(StackType_t)];
+
+    static void task_entry(void* param) {
+        StaticTask* self = (StaticTask*)param;
+        self->func();
+        self->handle = nullptr;
+        vTaskDelete(nullptr);
+    }
+};
+
+// ==================== PERIODIC TASK ====================
+// A StaticTask that runs `func` once per period, measured from the
+// previous release rather than from the end of the previous run, so the
+// rate does not drift with execution time. Periods that are whole ticks
+// use vTaskDelayUntil(); anything else (e.g. 1 kHz on a 100 Hz tick) is
+// released by a periodic esp_timer notifying the task.
+//   PeriodicTask<> control(controlStep, "ctrl", 1000, 5);   // 1 kHz
+//   PeriodicStats stats;
+//   control.getStats(stats);
+// Jitter is release lateness: activation time minus the ideal release
+// time. A run that ends after the next release is an overrun; in timer
+// mode the releases it swallowed are skipped, in tick mode the task
+// catches up back-to-back as vTaskDelayUntil() does.
+struct PeriodicStats {
+    uint32_t activations;
+    uint32_t overruns;
+    int32_t jitter_min_us;
+    int32_t jitter_max_us;
+    uint32_t exec_max_us;
+    uint32_t histogram[PERIODIC_JITTER_BINS];
+};
+
+template<uint32_t STACK_SIZE = PERIODIC_TASK_STACK>
+class PeriodicTask {
+public:
+    PeriodicTask()
+        : timer(nullptr), func(nullptr), period_us(0), first_release_us(0),
+          lock(portMUX_INITIALIZER_UNLOCKED) {
+        resetStats();
+    }
+
+    PeriodicTask(TaskFunction task_func, const char* name, uint32_t period,
+                 uint8_t priority = 1, int8_t core = -1)
+        : PeriodicTask() {
+        start(task_func, name, period, priority, core);
+    }
+
+    ~PeriodicTask() {
+        stop();
+    }
+
+    // The esp_timer holds a pointer to this object
+    PeriodicTask(const PeriodicTask&) = delete;
+    PeriodicTask& operator=(const PeriodicTask&) = delete;
+
+    // `period` in microseconds; false if already running or on failure
+    bool start(TaskFunction task_func, const char* name, uint32_t period,
+               uint8_t priority = 1, int8_t core = -1) {
+        if (task.running() || period == 0) return false;
+
+        func = task_func;
+        period_us = period;
+        resetStats();
+
+        if (!usesTicks()) {
+            esp_timer_create_args_t args = {};
+            args.callback = timer_callback;
+            args.arg = this;
+            args.dispatch_method = ESP_TIMER_TASK;
+            args.name = name;
+            if (esp_timer_create(&args, &timer) != ESP_OK) {
+                timer = nullptr;
+                return false;
+            }
+        }
+
+        if (!task.start([this]() { loop(); }, name, priority, core)) {
+            stop();
+            return false;
+        }
+
+        // Started here rather than by the task, so no release can come
+        // before the task's handle is known
+        if (timer) {
+            first_release_us = esp_timer_get_time();
+            esp_timer_start_periodic(timer, period_us);
+        }
+        return true;
+    }
+
+    void stop() {
+        if (timer) {
+            esp_timer_stop(timer);
+            esp_timer_delete(timer);
+            timer = nullptr;
+        }
+        task.stop();
+    }
+
+    bool running() const {
+        return task.running();
+    }
+
+    TaskHandle_t getHandle() const {
+        return task.getHandle();
+    }
+
+    uint32_t stackHighWater() const {
+        return task.stackHighWater();
+    }
+
+    uint32_t getPeriodUs() const {
+        return period_us;
+    }
+
+    // True when released by vTaskDelayUntil(), false when by esp_timer
+    bool usesTicks() const {
+        return period_us % TICK_US == 0;
+    }
+
+    // Consistent snapshot, safe from any task
+    void getStats(PeriodicStats& out) {
+        portENTER_CRITICAL(&lock);
+        out = stats;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void resetStats() {
+        portENTER_CRITICAL(&lock);
+        stats = {};
+        stats.jitter_min_us = INT32_MAX;
+        stats.jitter_max_us = INT32_MIN;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    uint32_t getOverrunCount() {
+        portENTER_CRITICAL(&lock);
+        uint32_t count = stats.overruns;
+        portEXIT_CRITICAL(&lock);
+        return count;
+    }
+
+private:
+    inline static constexpr uint32_t TICK_US = 1000000UL / configTICK_RATE_HZ;
+
+    StaticTask<STACK_SIZE> task;
+    esp_timer_handle_t timer;
+    TaskFunction func;
+    uint32_t period_us;
+    volatile int64_t first_release_us;
+    portMUX_TYPE lock;
+    PeriodicStats stats;
+
+    static void timer_callback(void* param) {
+        PeriodicTask* self = (PeriodicTask*)param;
+        self->task.notify();
+    }
+
+    void run(int64_t release_us) {
+        int64_t woke_us = esp_timer_get_time();
+        func();
+        int64_t done_us = esp_timer_get_time();
+
+        int32_t jitter = (int32_t)(woke_us - release_us);
+        uint32_t exec_us = (uint32_t)(done_us - woke_us);
+        uint32_t magnitude = jitter < 0 ? (uint32_t)-jitter : (uint32_t)jitter;
+        uint8_t bin = 0;
+        while (magnitude && bin < PERIODIC_JITTER_BINS - 1) {
+            magnitude >>= 1;
+            bin++;
+        }
+
+        portENTER_CRITICAL(&lock);
+        stats.activations++;
+        if (done_us > release_us + period_us) stats.overruns++;
+        if (jitter < stats.jitter_min_us) stats.jitter_min_us = jitter;
+        if (jitter > stats.jitter_max_us) stats.jitter_max_us = jitter;
+        if (exec_us > stats.exec_max_us) stats.exec_max_us = exec_us;
+        stats.histogram[bin]++;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void loop() {
+        if (timer) {
+            // Notifications coalesce: run once for the latest release
+            uint32_t releases = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            int64_t release_us = first_release_us;
+            forever() {
+                release_us += (int64_t)releases * period_us;
+                run(release_us);
+                releases = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+        } else {
+            vTaskDelay(1);  // Start on a tick boundary
+            TickType_t last_wake = xTaskGetTickCount();
+            int64_t release_us = esp_timer_get_time();
+            forever() {
+                run(release_us);
+                release_us += period_us;
+                vTaskDelayUntil(&last_wake, period_us / TICK_US);
+            }
+        }
     }
 };
 
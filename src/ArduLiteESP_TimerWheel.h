@@ -0,0 +1,300 @@
+#ifndef ARDULITEESP_TIMERWHEEL_H
+#define ARDULITEESP_TIMERWHEEL_H
+
+// Hierarchical timing wheel: software timers with O(1) start/stop, where
+// one tick only touches the timers that are due. Four levels of 64 slots
+// cover 2^24 ticks; longer timers are re-filed as the wheel turns.
+//
+//   TimerWheel timers;                    // 10 ms ticks
+//   SoftTimer heartbeat([]() { led1.toggle(); });
+//   SoftTimer timeout([]() { uart.sendLine("timeout"); });
+//
+//   timers.every(heartbeat, 500);
+//   timers.once(timeout, 2000);
+//   timers.begin();                       // Own task; or call update() from a loop
+//
+// Callbacks run on the wheel's task (or inside update()), one at a time
+// and outside the wheel lock, so they may start and stop timers. A timer
+// stopped from another task can still fire once if its callback had
+// already been picked up.
+
+#include "ArduLiteESP_Core.h"
+#include "ArduLiteESP_Callback.h"
+#include "ArduLiteESP_Task.h"
+
+// Timer Wheel Settings
+#define TIMER_WHEEL_TICK_MS                 10
+#define TIMER_WHEEL_BITS                    6     // 64 slots per level
+#define TIMER_WHEEL_LEVELS                  4
+#define TIMER_WHEEL_TASK_STACK              3072
+#define TIMER_WHEEL_TASK_PRIO               2
+
+using TimerCallback = Callback<void()>;
+
+class TimerWheel;
+
+// ==================== SOFT TIMER ====================
+class SoftTimer {
+public:
+    SoftTimer()
+        : next(nullptr), pprev(nullptr), wheel(nullptr), expires(0), period(0), active(false) {}
+
+    explicit SoftTimer(TimerCallback cb) : SoftTimer() {
+        callback = cb;
+    }
+
+    ~SoftTimer() {
+        stop();
+    }
+
+    // A linked timer is pointed at by its neighbours and the wheel slot
+    SoftTimer(const SoftTimer&) = delete;
+    SoftTimer& operator=(const SoftTimer&) = delete;
+
+    // Set before starting the timer
+    void onExpire(TimerCallback cb) {
+        callback = cb;
+    }
+
+    void stop();
+
+    bool isActive() const {
+        return active;
+    }
+
+private:
+    friend class TimerWheel;
+
+    SoftTimer* next;
+    SoftTimer** pprev;      // Link pointing at this timer, for O(1) unlink
+    TimerWheel* wheel;
+    uint32_t expires;       // Wheel tick
+    uint32_t period;        // Ticks, 0 = one-shot
+    volatile bool active;
+    TimerCallback callback;
+};
+
+// ==================== TIMER WHEEL ====================
+class TimerWheel {
+public:
+    explicit TimerWheel(uint32_t tick = TIMER_WHEEL_TICK_MS)
+        : tick_ms(tick ? tick : 1),
+          now(0),
+          synced(false),
+          active_count(0),
+          expired(nullptr),
+          lock(portMUX_INITIALIZER_UNLOCKED) {
+        for (uint8_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+            for (uint32_t slot = 0; slot < SLOTS; slot++) slots[level][slot] = nullptr;
+        }
+    }
+
+    // Turn the wheel from its own task every tick
+    void begin(uint8_t priority = TIMER_WHEEL_TASK_PRIO, uint32_t stack_size = TIMER_WHEEL_TASK_STACK) {
+        Task([this]() { run(); }, "timers", stack_size, priority);
+    }
+
+    // (Re)start `timer`: first expiry after `delay_ms`, then every
+    // `period_ms` (0 = one-shot). Rounded up to whole ticks.
+    void start(SoftTimer& timer, uint32_t delay_ms, uint32_t period_ms = 0) {
+        portENTER_CRITICAL(&lock);
+        sync();
+        if (timer.pprev) unlink(&timer);
+        else if (!timer.active) active_count++;
+        timer.wheel = this;
+        timer.expires = now + toTicks(delay_ms);
+        timer.period = period_ms ? toTicks(period_ms) : 0;
+        timer.active = true;
+        link(&timer);
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void once(SoftTimer& timer, uint32_t delay_ms) {
+        start(timer, delay_ms, 0);
+    }
+
+    void every(SoftTimer& timer, uint32_t period_ms) {
+        start(timer, period_ms, period_ms);
+    }
+
+    void stop(SoftTimer& timer) {
+        portENTER_CRITICAL(&lock);
+        if (timer.pprev) unlink(&timer);
+        if (timer.active) {
+            timer.active = false;
+            active_count--;
+        }
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // Advance to the current time and run what is due; one clock read
+    // per call however many timers there are. Returns callbacks run.
+    uint32_t update() {
+        return update(Instant::now());
+    }
+
+    uint32_t update(const Instant& t) {
+        uint32_t target = toTick(t.micros());
+        uint32_t fired = 0;
+
+        portENTER_CRITICAL(&lock);
+        sync();
+        if (active_count == 0 && (int32_t)(target - now) >= 0) now = target + 1;  // Nothing to visit
+        while ((int32_t)(target - now) >= 0) {
+            tick();
+            portEXIT_CRITICAL(&lock);
+            fired += runExpired();
+            portENTER_CRITICAL(&lock);
+        }
+        portEXIT_CRITICAL(&lock);
+        return fired;
+    }
+
+    uint32_t getActiveCount() const {
+        return active_count;
+    }
+
+    uint32_t getTickMs() const {
+        return tick_ms;
+    }
+
+private:
+    inline static constexpr uint32_t SLOTS = 1UL << TIMER_WHEEL_BITS;
+    inline static constexpr uint32_t MASK = SLOTS - 1;
+    inline static constexpr uint32_t RANGE = 1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS);
+
+    uint32_t tick_ms;
+    uint32_t now;           // Next tick to process
+    bool synced;
+    uint32_t active_count;
+    SoftTimer* expired;     // Due this tick, callbacks not yet run
+    portMUX_TYPE lock;
+    SoftTimer* slots[TIMER_WHEEL_LEVELS][SLOTS];
+
+    // Ticks come from the 64-bit clock: the 32-bit count then wraps
+    // cleanly after 2^32 ticks, where millis() / tick_ms would jump back
+    // to 0 when millis() wraps after 49.7 days
+    uint32_t toTick(int64_t time_us) const {
+        return (uint32_t)((uint64_t)time_us / 1000 / tick_ms);
+    }
+
+    uint32_t toTicks(uint32_t ms) const {
+        uint32_t ticks = (ms + tick_ms - 1) / tick_ms;
+        return ticks ? ticks : 1;
+    }
+
+    void sync() {
+        if (synced) return;
+        now = toTick(esp_timer_get_time());
+        synced = true;
+    }
+
+    static void push(SoftTimer** head, SoftTimer* timer) {
+        timer->next = *head;
+        if (*head) (*head)->pprev = &timer->next;
+        *head = timer;
+        timer->pprev = head;
+    }
+
+    static void unlink(SoftTimer* timer) {
+        *timer->pprev = timer->next;
+        if (timer->next) timer->next->pprev = timer->pprev;
+        timer->next = nullptr;
+        timer->pprev = nullptr;
+    }
+
+    // File a timer in the lowest level whose span covers its delay
+    void link(SoftTimer* timer) {
+        uint32_t delta = timer->expires - now;
+        if ((int32_t)delta < 0) {
+            timer->expires = now;
+            delta = 0;
+        }
+
+        if (delta < SLOTS) {
+            push(&slots[0][timer->expires & MASK], timer);
+            return;
+        }
+
+        uint32_t when = delta < RANGE ? timer->expires : now + RANGE - 1;
+        uint8_t level = 1;
+        while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1UL << (TIMER_WHEEL_BITS * (level + 1)))) {
+            level++;
+        }
+        push(&slots[level][(when >> (TIMER_WHEEL_BITS * level)) & MASK], timer);
+    }
+
+    // Re-file every timer of an upper-level slot one level closer
+    void cascade(uint8_t level, uint32_t index) {
+        SoftTimer* timer = slots[level][index];
+        slots[level][index] = nullptr;
+        while (timer) {
+            SoftTimer* following = timer->next;
+            timer->pprev = nullptr;
+            link(timer);
+            timer = following;
+        }
+    }
+
+    // Process tick `now` (lock held): cascade on wrap, then move the due
+    // slot to the expired list
+    void tick() {
+        uint32_t index = now & MASK;
+        if (index == 0) {
+            for (uint8_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+                uint32_t upper = (now >> (TIMER_WHEEL_BITS * level)) & MASK;
+                cascade(level, upper);
+                if (upper != 0) break;
+            }
+        }
+
+        SoftTimer* timer = slots[0][index];
+        slots[0][index] = nullptr;
+        while (timer) {
+            SoftTimer* following = timer->next;
+            push(&expired, timer);
+            timer = following;
+        }
+        now++;
+    }
+
+    uint32_t runExpired() {
+        uint32_t fired = 0;
+        forever() {
+            portENTER_CRITICAL(&lock);
+            SoftTimer* timer = expired;
+            if (!timer) {
+                portEXIT_CRITICAL(&lock);
+                return fired;
+            }
+            unlink(timer);
+            if (timer->period) {
+                timer->expires += timer->period;  // Drift-free
+                link(timer);
+            } else {
+                timer->active = false;
+                active_count--;
+            }
+            portEXIT_CRITICAL(&lock);
+
+            if (timer->callback) timer->callback();
+            fired++;
+        }
+    }
+
+    void run() {
+        TickType_t period = pdMS_TO_TICKS(tick_ms);
+        if (period == 0) period = 1;
+        TickType_t last_wake = xTaskGetTickCount();
+        forever() {
+            vTaskDelayUntil(&last_wake, period);
+            update();
+        }
+    }
+};
+
+inline void SoftTimer::stop() {
+    if (wheel) wheel->stop(*this);
+}
+
+#endif
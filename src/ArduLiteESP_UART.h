@@ -2,6 +2,8 @@
 #define ARDULITEESP_UART_H
 
 #include "ArduLiteESP_Core.h"
+#include "ArduLiteESP_Ring.h"
+#include "ArduLiteESP_Callback.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -10,18 +12,23 @@ extern "C" {
 #include "driver/uart.h"
 #include "freertos/queue.h"
 #include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 }
 #endif
 
+#include <math.h>
+
 class UART {
 public:
     // Configuration constants (no magic numbers)
-    inline static constexpr size_t BUFFER_SIZE = 64;
+    inline static constexpr size_t BUFFER_SIZE = 64;      // Default line buffer, 63 chars + NUL
     inline static constexpr size_t NUMERIC_BUF_SIZE = 34; // enough for 32-bit binary + terminator
-    inline static constexpr size_t FLOAT_BUF_SIZE = 16;
-    inline static constexpr size_t DTOSTRF_FMT_SIZE = 24;
+    inline static constexpr size_t FLOAT_BUF_SIZE = 24;   // sign + 10 digits + '.' + 9 decimals + NUL
+    inline static constexpr uint8_t FLOAT_MAX_DECIMALS = 9; // A float has no more significant digits
+    inline static constexpr size_t SEND_BUF_SIZE = 128;   // Stack staging for one-write lines and printf()
 
     inline static constexpr int UART_DRIVER_BUF_SIZE = 1024;
     inline static constexpr int UART_RX_QUEUE_LENGTH = 10;
@@ -29,6 +36,23 @@ public:
     inline static constexpr UBaseType_t UART_RX_TASK_PRIO = 5;
     inline static constexpr int UART_RX_FLOW_CTRL_THRESH = 122;
     inline static constexpr int UART_READ_NO_WAIT_MS = 0;
+    inline static constexpr size_t UART_RX_CHUNK_SIZE = 128;
+    inline static constexpr int UART_PATTERN_GAP = 9;       // Max baud cycles between repeated delimiters
+    inline static constexpr size_t UART_LINE_QUEUE_SIZE = 512;
+
+    // Completed lines handed from the RX task to a polling task
+    using LineQueue = SPSCRing<char, UART_LINE_QUEUE_SIZE>;
+
+    // Receive callbacks accept plain functions or capturing lambdas
+    using LineCallback = Callback<void(const char *)>;
+    using SpanCallback = Callback<void(const char *, size_t)>;
+    using ReceiveHandler = Callback<void(const uint8_t *, size_t)>;
+
+    // What happens to a line longer than the line buffer
+    inline static constexpr uint8_t OVERFLOW_RESET = 0;     // Restart the line, keep collecting (default)
+    inline static constexpr uint8_t OVERFLOW_TRUNCATE = 1;  // Deliver the first bytes, skip the rest
+    inline static constexpr uint8_t OVERFLOW_DROP = 2;      // Skip the whole line
+    inline static constexpr uint8_t OVERFLOW_PARTIAL = 3;   // Deliver the line in buffer-sized pieces
 
     static inline int8_t default_tx_pin(uart_port_t port) {
         switch (port) {
@@ -51,9 +75,21 @@ public:
     explicit UART(uart_port_t port)
         : uart_num(port),
           data_callback(nullptr),
+          span_callback(nullptr),
+          raw_handler(nullptr),
+          line_queue(nullptr),
+          line_queue_dropped(0),
           rx_queue(nullptr),
           rx_task_handle(nullptr),
-          index(0) {
+          buffer(line_storage),
+          buffer_size(BUFFER_SIZE),
+          index(0),
+          overflow_policy(OVERFLOW_RESET),
+          discarding(false),
+          partial(false),
+          pattern_char('\n'),
+          pattern_count(0),
+          pattern_gap(UART_PATTERN_GAP) {
         buffer[0] = '\0';
     }
 
@@ -65,7 +101,7 @@ public:
         uart_driver_delete(uart_num);
     }
 
-    void begin(uint32_t baud, void (*callback)(const char *) = nullptr,
+    void begin(uint32_t baud, LineCallback callback = nullptr,
                int8_t tx_pin = -1, int8_t rx_pin = -1) {
 
         data_callback = callback;
@@ -87,7 +123,13 @@ public:
         uart_driver_install(uart_num, UART_DRIVER_BUF_SIZE, UART_DRIVER_BUF_SIZE,
                     UART_RX_QUEUE_LENGTH, &rx_queue, 0);
 
-        if (data_callback) {
+        if (pattern_count > 0) {
+            uart_enable_pattern_det_baud_intr(uart_num, pattern_char, pattern_count,
+                                              pattern_gap, 0, 0);
+            uart_pattern_queue_reset(uart_num, UART_RX_QUEUE_LENGTH);
+        }
+
+        if (data_callback || span_callback || raw_handler || line_queue) {
             xTaskCreate(
                 rx_task_entry,
                 "uart_rx",
@@ -107,16 +149,32 @@ public:
         uart_write_bytes(uart_num, str, strlen(str));
     }
 
+    // Raw bytes handed to the driver in a single call
+    int write(const uint8_t *data, size_t length) {
+        return uart_write_bytes(uart_num, (const char*)data, length);
+    }
+
+    // Formatted output assembled on the stack and written in one call;
+    // longer output is cut at SEND_BUF_SIZE - 1 characters
+    int printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+        char buf[SEND_BUF_SIZE];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (len <= 0) return len;
+        if ((size_t)len >= sizeof(buf)) len = sizeof(buf) - 1;
+        return uart_write_bytes(uart_num, buf, len);
+    }
+
     void send(int32_t data) {
-        char buf[12];
-        itoa(data, buf, 10);
-        send(buf);
+        char buf[NUMERIC_BUF_SIZE];
+        uart_write_bytes(uart_num, buf, formatSigned(data, buf));
     }
 
     void send(uint32_t data) {
-        char buf[12];
-        utoa(data, buf, 10);
-        send(buf);
+        char buf[NUMERIC_BUF_SIZE];
+        uart_write_bytes(uart_num, buf, formatUnsigned(data, buf));
     }
 
     void send(uint16_t data) {
@@ -138,8 +196,7 @@ public:
     // Send with base (HEX, BIN, OCT, DEC)
     void send(uint32_t data, uint8_t base) {
         char buf[NUMERIC_BUF_SIZE];
-        utoa(data, buf, base);
-        send(buf);
+        uart_write_bytes(uart_num, buf, formatUnsigned(data, buf, base));
     }
 
     void send(uint16_t data, uint8_t base) {
@@ -151,11 +208,8 @@ public:
     }
 
     void send(int32_t data, uint8_t base) {
-        if (data < 0 && base == 10) {
-            send('-');
-            data = -data;
-        }
-        send((uint32_t)data, base);
+        char buf[NUMERIC_BUF_SIZE];
+        uart_write_bytes(uart_num, buf, formatSigned(data, buf, base));
     }
 
     void send(int16_t data, uint8_t base) {
@@ -168,8 +222,7 @@ public:
 
     void send(float data, uint8_t decimals = 2) {
         char buf[FLOAT_BUF_SIZE];
-        dtostrf(data, 1, decimals, buf);
-        send(buf);
+        uart_write_bytes(uart_num, buf, formatFloat(data, decimals, buf));
     }
 
     void send(double data, uint8_t decimals = 2) {
@@ -180,90 +233,176 @@ public:
         send(data ? "true" : "false");
     }
 
+    // sendLine() appends "\r\n" to the value and writes both at once
     void sendLine(char data) {
-        send(data);
-        send("\r\n");
+        char buf[3] = { data, '\r', '\n' };
+        uart_write_bytes(uart_num, buf, sizeof(buf));
     }
 
     void sendLine(const char *str) {
-        send(str);
-        send("\r\n");
+        size_t len = strlen(str);
+        if (len > SEND_BUF_SIZE - 2) {
+            uart_write_bytes(uart_num, str, len);
+            send("\r\n");
+            return;
+        }
+        char buf[SEND_BUF_SIZE];
+        memcpy(buf, str, len);
+        writeLine(buf, len);
     }
 
     void sendLine(int32_t data) {
-        send(data);
-        send("\r\n");
+        char buf[NUMERIC_BUF_SIZE + 2];
+        writeLine(buf, formatSigned(data, buf));
     }
 
     void sendLine(uint32_t data) {
-        send(data);
-        send("\r\n");
+        char buf[NUMERIC_BUF_SIZE + 2];
+        writeLine(buf, formatUnsigned(data, buf));
     }
 
     void sendLine(uint16_t data) {
-        send(data);
-        send("\r\n");
+        sendLine((uint32_t)data);
     }
 
     void sendLine(int16_t data) {
-        send(data);
-        send("\r\n");
+        sendLine((int32_t)data);
     }
 
     void sendLine(uint8_t data) {
-        send(data);
-        send("\r\n");
+        sendLine((uint32_t)data);
     }
 
     void sendLine(int8_t data) {
-        send(data);
-        send("\r\n");
+        sendLine((int32_t)data);
     }
 
     // SendLine with base (HEX, BIN, OCT, DEC)
     void sendLine(uint32_t data, uint8_t base) {
-        send(data, base);
-        send("\r\n");
+        char buf[NUMERIC_BUF_SIZE + 2];
+        writeLine(buf, formatUnsigned(data, buf, base));
     }
 
     void sendLine(uint16_t data, uint8_t base) {
-        send(data, base);
-        send("\r\n");
+        sendLine((uint32_t)data, base);
     }
 
     void sendLine(uint8_t data, uint8_t base) {
-        send(data, base);
-        send("\r\n");
+        sendLine((uint32_t)data, base);
     }
 
     void sendLine(int32_t data, uint8_t base) {
-        send(data, base);
-        send("\r\n");
+        char buf[NUMERIC_BUF_SIZE + 2];
+        writeLine(buf, formatSigned(data, buf, base));
     }
 
     void sendLine(int16_t data, uint8_t base) {
-        send(data, base);
-        send("\r\n");
+        sendLine((int32_t)data, base);
     }
 
     void sendLine(int8_t data, uint8_t base) {
-        send(data, base);
-        send("\r\n");
+        sendLine((int32_t)data, base);
     }
 
     void sendLine(float data, uint8_t decimals = 2) {
-        send(data, decimals);
-        send("\r\n");
+        char buf[FLOAT_BUF_SIZE + 2];
+        writeLine(buf, formatFloat(data, decimals, buf));
     }
 
     void sendLine(double data, uint8_t decimals = 2) {
-        send(data, decimals);
-        send("\r\n");
+        sendLine((float)data, decimals);
     }
 
     void sendLine(bool data) {
-        send(data);
-        send("\r\n");
+        sendLine(data ? "true" : "false");
+    }
+
+    // Number formatting shared with UARTWriter. Each writes a
+    // NUL-terminated string to `out` and returns its length.
+
+    // `out` holds NUMERIC_BUF_SIZE; bases 2-36, lowercase digits
+    static size_t formatUnsigned(uint32_t value, char *out, uint8_t base = 10) {
+        char tmp[NUMERIC_BUF_SIZE];
+        char *p = tmp + sizeof(tmp);
+
+        if (base == 10) {
+            // Two digits per division
+            while (value >= 100) {
+                uint32_t q = value / 100;
+                p -= 2;
+                memcpy(p, &DIGIT_PAIRS[(value - q * 100) * 2], 2);
+                value = q;
+            }
+            if (value >= 10) {
+                p -= 2;
+                memcpy(p, &DIGIT_PAIRS[value * 2], 2);
+            } else {
+                *--p = (char)('0' + value);
+            }
+        } else {
+            if (base < 2 || base > 36) base = 10;
+            do {
+                *--p = DIGITS[value % base];
+                value /= base;
+            } while (value);
+        }
+
+        size_t len = tmp + sizeof(tmp) - p;
+        memcpy(out, p, len);
+        out[len] = '\0';
+        return len;
+    }
+
+    // Negative values get a '-' in base 10 and are sent as their
+    // two's complement in other bases
+    static size_t formatSigned(int32_t value, char *out, uint8_t base = 10) {
+        if (value < 0 && base == 10) {
+            out[0] = '-';
+            return 1 + formatUnsigned(0u - (uint32_t)value, out + 1);
+        }
+        return formatUnsigned((uint32_t)value, out, base);
+    }
+
+    // `out` holds FLOAT_BUF_SIZE. Fixed-point conversion for up to 7
+    // decimals and |value| < 4e9, snprintf() for everything else; from
+    // 4e9 up the exponent form is used so the output always fits.
+    // Decimals are capped at FLOAT_MAX_DECIMALS.
+    static size_t formatFloat(float value, uint8_t decimals, char *out) {
+        bool negative = signbit(value);
+        double x = negative ? -(double)value : (double)value;
+        if (decimals > FLOAT_MAX_DECIMALS) decimals = FLOAT_MAX_DECIMALS;
+
+        if (!(x < 4.0e9)) {
+            return (size_t)snprintf(out, FLOAT_BUF_SIZE, "%.*e", decimals, (double)value);
+        }
+        if (decimals > 7) {
+            return (size_t)snprintf(out, FLOAT_BUF_SIZE, "%.*f", decimals, (double)value);
+        }
+
+        // A float times 10^7 is exact in a double, so ties can be rounded
+        // to even the same way printf() does
+        uint32_t scale = POW10[decimals];
+        double scaled = x * scale;
+        uint64_t fixed = (uint64_t)scaled;
+        double rest = scaled - (double)fixed;
+        if (rest > 0.5 || (rest == 0.5 && (fixed & 1))) fixed++;
+        uint32_t whole = (uint32_t)(fixed / scale);
+        uint32_t frac = (uint32_t)(fixed % scale);
+
+        size_t len = 0;
+        if (negative) out[len++] = '-';
+        len += formatUnsigned(whole, out + len);
+
+        if (decimals > 0) {
+            out[len++] = '.';
+            for (uint8_t i = decimals; i > 0; i--) {
+                out[len + i - 1] = (char)('0' + frac % 10);
+                frac /= 10;
+            }
+            len += decimals;
+            out[len] = '\0';
+        }
+        return len;
     }
 
     int available() {
@@ -286,54 +425,369 @@ public:
 
     void flush() {
         uart_flush(uart_num);
+        if (rx_queue && !rx_task_handle) xQueueReset(rx_queue);
+    }
+
+    // Line callback that receives a pointer + length view instead of a
+    // NUL-terminated string. Lines that arrive within one driver read
+    // point straight into the RX chunk, without a copy. Call before begin().
+    void onLine(SpanCallback callback) {
+        span_callback = callback;
+    }
+
+    // Queue received lines for readLine() instead of (or as well as)
+    // running a callback on the RX task. Call before begin().
+    //   static UART::LineQueue lines;
+    //   uart1.setLineQueue(lines);
+    //   uart1.begin(115200);
+    //   if (uart1.readLine(buf, sizeof(buf))) { ... }
+    void setLineQueue(LineQueue &queue) {
+        line_queue = &queue;
+    }
+
+    // Take the oldest queued line; longer lines are cut to `size - 1`
+    bool readLine(char *line, size_t size) {
+        if (!line_queue || size == 0 || line_queue->empty()) return false;
+
+        size_t length = 0;
+        char c;
+        while (line_queue->pop(c) && c != '\0') {
+            if (length < size - 1) line[length++] = c;
+        }
+        line[length] = '\0';
+        return true;
+    }
+
+    // Lines lost because the queue was full
+    uint32_t getLineQueueDropped() {
+        return line_queue_dropped;
+    }
+
+    // Hand every received chunk to `handler` as-is, bypassing line
+    // splitting; used by binary protocols such as UARTPacket. Not combined
+    // with setFrameDelimiter(). Call before begin().
+    void setReceiveHandler(ReceiveHandler handler) {
+        raw_handler = handler;
+    }
+
+    void setReceiveHandler(void (*handler)(void *, const uint8_t *, size_t), void *context) {
+        raw_handler = [handler, context](const uint8_t *data, size_t length) {
+            handler(context, data, length);
+        };
+    }
+
+    // Use caller-owned storage for line assembly, allowing lines of up to
+    // `size - 1` characters. Call before begin().
+    //   static char line[512];
+    //   uart1.setLineBuffer(line);
+    void setLineBuffer(char *storage, size_t size) {
+        if (!storage || size < 2) return;
+        buffer = storage;
+        buffer_size = size;
+        index = 0;
+        discarding = false;
+    }
+
+    template<size_t N>
+    void setLineBuffer(char (&storage)[N]) {
+        setLineBuffer(storage, N);
+    }
+
+    // Let the UART hardware find frame ends. The RX task then wakes once
+    // per frame and reads it with a single driver call instead of scanning
+    // every byte. A frame is everything before `count` consecutive
+    // `delimiter` characters (at most `gap` baud cycles apart); with the
+    // default '\n' a trailing '\r' is stripped too. Call before begin().
+    //   uart1.setFrameDelimiter('\n');
+    //   uart1.begin(921600, onLine);
+    void setFrameDelimiter(char delimiter, uint8_t count = 1, int gap = UART_PATTERN_GAP) {
+        pattern_char = delimiter;
+        pattern_count = count;
+        pattern_gap = gap;
+    }
+
+    void setOverflowPolicy(uint8_t policy) {
+        overflow_policy = policy;
+    }
+
+    size_t getMaxLineLength() {
+        return buffer_size - 1;
+    }
+
+    // Inside a callback with OVERFLOW_PARTIAL: true when the line continues
+    // in the next callback
+    bool isPartialLine() {
+        return partial;
+    }
+
+    // RS-485 half-duplex: the driver drives `de_pin` (RTS) high while
+    // transmitting and releases it as soon as the last stop bit is out
+    bool setRS485(int8_t de_pin) {
+        if (uart_set_pin(uart_num, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE,
+                         de_pin, UART_PIN_NO_CHANGE) != ESP_OK) return false;
+        return uart_set_mode(uart_num, UART_MODE_RS485_HALF_DUPLEX) == ESP_OK;
+    }
+
+    // Block until the TX FIFO has fully drained onto the wire
+    bool waitTxDone(uint32_t timeout_ms = 100) {
+        return uart_wait_tx_done(uart_num, pdMS_TO_TICKS(timeout_ms)) == ESP_OK;
+    }
+
+    uint32_t getBaudRate() {
+        uint32_t baud = 0;
+        uart_get_baudrate(uart_num, &baud);
+        return baud;
+    }
+
+    // Post a UART_DATA event with timeout_flag set after `symbols`
+    // character times of RX line silence (1-126)
+    void setRxTimeout(uint8_t symbols) {
+        uart_set_rx_timeout(uart_num, symbols);
+    }
+
+    // Wait for a driver event. Only available when begin() was called
+    // without a callback (otherwise the RX task owns the event queue).
+    bool waitEvent(uart_event_t &event, uint32_t timeout_ms) {
+        if (!canWaitEvent()) return false;
+        TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
+        if (ticks == 0 && timeout_ms > 0) ticks = 1;
+        return xQueueReceive(rx_queue, &event, ticks) == pdTRUE;
+    }
+
+    // False before begin() or while an RX task owns the event queue, in
+    // which case waitEvent() returns at once
+    bool canWaitEvent() const {
+        return rx_queue && !rx_task_handle;
     }
 
 private:
     uart_port_t uart_num;
-    void (*data_callback)(const char *);
+    LineCallback data_callback;
+    SpanCallback span_callback;
+    ReceiveHandler raw_handler;
+    LineQueue *line_queue;
+    uint32_t line_queue_dropped;
     QueueHandle_t rx_queue;
     TaskHandle_t rx_task_handle;
 
-    char buffer[BUFFER_SIZE];
-    uint8_t index;
+    char line_storage[BUFFER_SIZE];
+    char *buffer;
+    size_t buffer_size;
+    size_t index;
+    uint8_t overflow_policy;
+    bool discarding;  // Skipping the rest of an overflowed line
+    bool partial;
+
+    char pattern_char;
+    uint8_t pattern_count;  // 0 = software line splitting
+    int pattern_gap;
 
     static void rx_task_entry(void *param) {
         UART *self = (UART*)param;
         uart_event_t event;
-        uint8_t data;
+        char chunk[UART_RX_CHUNK_SIZE];
 
         while (true) {
             if (xQueueReceive(self->rx_queue, &event, portMAX_DELAY)) {
-                if (event.type == UART_DATA) {
-                    while (uart_read_bytes(self->uart_num, &data, 1, 0) > 0) {
-                        self->receive((char)data);
+                switch (event.type) {
+                    case UART_PATTERN_DET:
+                        self->receivePattern(chunk, sizeof(chunk));
+                        break;
+                    case UART_DATA: {
+                        // Pattern mode leaves data in the ring buffer until the frame ends
+                        if (self->pattern_count > 0) break;
+
+                        // Drain the whole event with as few driver calls as possible
+                        size_t pending = event.size;
+                        while (pending > 0) {
+                            size_t want = pending < sizeof(chunk) ? pending : sizeof(chunk);
+                            int len = uart_read_bytes(self->uart_num, (uint8_t*)chunk, want, 0);
+                            if (len <= 0) break;
+                            if (self->raw_handler) {
+                                self->raw_handler((const uint8_t*)chunk, (size_t)len);
+                            } else {
+                                self->receive(chunk, (size_t)len);
+                            }
+                            pending -= len;
+                        }
+                        break;
                     }
+                    case UART_FIFO_OVF:
+                    case UART_BUFFER_FULL:
+                        // Data was lost, the partial line can't be trusted
+                        uart_flush_input(self->uart_num);
+                        xQueueReset(self->rx_queue);
+                        if (self->pattern_count > 0) {
+                            uart_pattern_queue_reset(self->uart_num, UART_RX_QUEUE_LENGTH);
+                        }
+                        self->index = 0;
+                        self->discarding = false;
+                        break;
+                    default:
+                        break;
                 }
             }
         }
     }
 
-    void receive(char received) {
-        if (received == '\n' || received == '\r') {
-            if (index > 0) {
-                buffer[index] = '\0';
-                if (data_callback) {
-                    data_callback(buffer);
-                }
-                index = 0;
+    // First '\r' or '\n' in [data, data + length), or nullptr
+    static char* find_eol(char *data, size_t length) {
+        char *lf = (char*)memchr(data, '\n', length);
+        size_t limit = lf ? (size_t)(lf - data) : length;
+        char *cr = (char*)memchr(data, '\r', limit);
+        return cr ? cr : lf;
+    }
+
+    // `data` must be NUL-terminated at `length`
+    void deliver(const char *data, size_t length, bool more) {
+        partial = more;
+        if (span_callback) span_callback(data, length);
+        if (data_callback) data_callback(data);
+        if (line_queue) {
+            // Line and terminator are published together or not at all
+            if (line_queue->space() > length) {
+                line_queue->write(data, length + 1);
+            } else {
+                line_queue_dropped++;
             }
-        } else if (index < sizeof(buffer) - 1) {
-            buffer[index++] = received;
-        } else {
+        }
+    }
+
+    // Append a terminator-free segment to the line buffer, applying the
+    // overflow policy once it is full
+    void append(const char *data, size_t length) {
+        size_t max_length = buffer_size - 1;
+
+        while (length > 0 && !discarding) {
+            size_t space = max_length - index;
+            if (length <= space) {
+                memcpy(&buffer[index], data, length);
+                index += length;
+                return;
+            }
+
+            switch (overflow_policy) {
+                case OVERFLOW_TRUNCATE:
+                    memcpy(&buffer[index], data, space);
+                    index = max_length;
+                    discarding = true;
+                    return;
+                case OVERFLOW_DROP:
+                    index = 0;
+                    discarding = true;
+                    return;
+                case OVERFLOW_PARTIAL:
+                    memcpy(&buffer[index], data, space);
+                    buffer[max_length] = '\0';
+                    deliver(buffer, max_length, true);
+                    index = 0;
+                    data += space;
+                    length -= space;
+                    break;
+                default:
+                    // The overflowing byte is lost and collection restarts
+                    memcpy(&buffer[index], data, space);
+                    index = 0;
+                    data += space + 1;
+                    length -= space + 1;
+                    break;
+            }
+        }
+    }
+
+    void endLine() {
+        if (index > 0) {
+            buffer[index] = '\0';
+            deliver(buffer, index, false);
+            index = 0;
+        }
+        discarding = false;
+    }
+
+    // Read one hardware-detected frame. A frame that fits the chunk is
+    // read together with its delimiter in one call and delivered in place.
+    void receivePattern(char *chunk, size_t chunk_size) {
+        int position = uart_pattern_pop_pos(uart_num);
+        if (position < 0) {
+            // Pattern position queue overflowed, frame boundaries are lost
+            uart_flush_input(uart_num);
+            uart_pattern_queue_reset(uart_num, UART_RX_QUEUE_LENGTH);
             index = 0;
+            discarding = false;
+            return;
+        }
+
+        size_t length = (size_t)position;
+        size_t frame_length = length + pattern_count;
+
+        if (index == 0 && frame_length < chunk_size) {
+            int len = uart_read_bytes(uart_num, (uint8_t*)chunk, frame_length, 0);
+            if (len < (int)frame_length) return;
+            if (pattern_char == '\n' && length > 0 && chunk[length - 1] == '\r') length--;
+
+            if (length >= buffer_size) {
+                append(chunk, length);
+                endLine();
+            } else if (length > 0) {
+                chunk[length] = '\0';
+                deliver(chunk, length, false);
+            }
+            return;
         }
+
+        // Long frame: assemble it in the line buffer
+        while (length > 0) {
+            size_t want = length < chunk_size ? length : chunk_size;
+            int len = uart_read_bytes(uart_num, (uint8_t*)chunk, want, 0);
+            if (len <= 0) return;
+            length -= len;
+            if (length == 0 && pattern_char == '\n' && chunk[len - 1] == '\r') len--;
+            append(chunk, (size_t)len);
+        }
+        uart_read_bytes(uart_num, (uint8_t*)chunk, pattern_count, 0);
+        endLine();
     }
 
-    static char* dtostrf(double val, signed char width, unsigned char prec, char *s) {
-        char fmt[DTOSTRF_FMT_SIZE];
-        snprintf(fmt, sizeof(fmt), "%%%d.%df", width, prec);
-        snprintf(s, FLOAT_BUF_SIZE, fmt, val);
-        return s;
+    // Split a received chunk into lines. A line that starts and ends
+    // inside the chunk is terminated in place and handed to the callback
+    // without being copied into the line buffer.
+    void receive(char *data, size_t length) {
+        char *end = data + length;
+
+        while (data < end) {
+            char *eol = find_eol(data, end - data);
+
+            if (!eol) {
+                append(data, end - data);
+                return;
+            }
+
+            size_t line_length = eol - data;
+            if (index == 0 && !discarding && line_length < buffer_size) {
+                if (line_length > 0) {
+                    *eol = '\0';
+                    deliver(data, line_length, false);
+                }
+            } else {
+                append(data, line_length);
+                endLine();
+            }
+            data = eol + 1;
+        }
+    }
+
+    inline static constexpr char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    inline static constexpr char DIGIT_PAIRS[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+    inline static constexpr uint32_t POW10[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000
+    };
+
+    // `buf` has two spare bytes after `length`
+    void writeLine(char *buf, size_t length) {
+        buf[length++] = '\r';
+        buf[length++] = '\n';
+        uart_write_bytes(uart_num, buf, length);
     }
 };
 
@@ -341,8 +795,135 @@ UART uart(UART_NUM_0);
 UART uart1(UART_NUM_1);
 UART uart2(UART_NUM_2);
 
+// ==================== UART WRITER ====================
+// Assembles a record from mixed values on the stack and hands it to the
+// driver in one write, instead of one write per value.
+//   UARTWriter<> out(uart1);
+//   out.send("T=").send(temperature, 1).send(",N=").sendLine(count);
+// Output is flushed by sendLine(), when the buffer fills, or when the
+// writer goes out of scope.
+template<size_t N = UART::SEND_BUF_SIZE>
+class UARTWriter {
+    static_assert(N >= UART::FLOAT_BUF_SIZE + 2, "UARTWriter buffer too small");
+
+public:
+    explicit UARTWriter(UART &port) : port(port), length(0) {}
+
+    ~UARTWriter() {
+        flush();
+    }
+
+    UARTWriter &send(char data) {
+        reserve(1);
+        buffer[length++] = data;
+        return *this;
+    }
+
+    UARTWriter &send(const char *str) {
+        append(str, strlen(str));
+        return *this;
+    }
+
+    UARTWriter &send(int32_t data, uint8_t base = 10) {
+        reserve(UART::NUMERIC_BUF_SIZE);
+        length += UART::formatSigned(data, &buffer[length], base);
+        return *this;
+    }
+
+    UARTWriter &send(uint32_t data, uint8_t base = 10) {
+        reserve(UART::NUMERIC_BUF_SIZE);
+        length += UART::formatUnsigned(data, &buffer[length], base);
+        return *this;
+    }
+
+    UARTWriter &send(uint16_t data, uint8_t base = 10) {
+        return send((uint32_t)data, base);
+    }
+
+    UARTWriter &send(int16_t data, uint8_t base = 10) {
+        return send((int32_t)data, base);
+    }
+
+    UARTWriter &send(uint8_t data, uint8_t base = 10) {
+        return send((uint32_t)data, base);
+    }
+
+    UARTWriter &send(int8_t data, uint8_t base = 10) {
+        return send((int32_t)data, base);
+    }
+
+    UARTWriter &send(float data, uint8_t decimals = 2) {
+        reserve(UART::FLOAT_BUF_SIZE);
+        length += UART::formatFloat(data, decimals, &buffer[length]);
+        return *this;
+    }
+
+    UARTWriter &send(double data, uint8_t decimals = 2) {
+        return send((float)data, decimals);
+    }
+
+    UARTWriter &send(bool data) {
+        return send(data ? "true" : "false");
+    }
+
+    // End the record and write it out
+    UARTWriter &sendLine() {
+        append("\r\n", 2);
+        flush();
+        return *this;
+    }
+
+    template<typename T>
+    UARTWriter &sendLine(T data) {
+        send(data);
+        return sendLine();
+    }
+
+    template<typename T>
+    UARTWriter &sendLine(T data, uint8_t param) {
+        send(data, param);
+        return sendLine();
+    }
+
+    void flush() {
+        if (length > 0) {
+            port.write((const uint8_t*)buffer, length);
+            length = 0;
+        }
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    UART &port;
+    size_t length;
+    char buffer[N];
+
+    // Make room for `count` bytes (formatters also write a NUL)
+    void reserve(size_t count) {
+        if (length + count > N) flush();
+    }
+
+    void append(const char *data, size_t count) {
+        if (length + count > N) {
+            flush();
+            if (count > N) {
+                port.write((const uint8_t*)data, count);
+                return;
+            }
+        }
+        memcpy(&buffer[length], data, count);
+        length += count;
+    }
+};
+
 // Debug Macros
-#ifdef DEBUG
+#if defined(DEBUG) && defined(DEBUG_DEFERRED)
+    // Recorded into the binary log ring, see ArduLiteESP_Log.h
+    #include "ArduLiteESP_Log.h"
+#elif defined(DEBUG)
     // Single parameter
     template<typename T>
     inline void debug(T data) {
@@ -0,0 +1,119 @@
+#ifndef ARDULITEESP_WHEELIO_H
+#define ARDULITEESP_WHEELIO_H
+
+// Drive an LED or Button from a TimerWheel instead of polling update()
+// from the loop. The adapters own the SoftTimer; LED and Button stay
+// plain polled classes.
+//
+//   TimerWheel timers;
+//   WheelLED status(led1);
+//   WheelButton start(btn1);
+//
+//   status.blink(500, timers);            // No led1.update() needed
+//   start.attach(timers);                 // Debounced on the wheel
+//   timers.begin();
+//
+//   if (start.pressed()) { ... }          // Latched edge, safe from any task
+
+#include "ArduLiteESP_TimerWheel.h"
+#include "ArduLiteESP_LED.h"
+#include "ArduLiteESP_Button.h"
+#include <atomic>
+
+// Wheel IO Settings
+#define BUTTON_SAMPLE_MS                    10    // TimerWheel sampling period
+
+// ==================== WHEEL LED ====================
+class WheelLED {
+public:
+    explicit WheelLED(LED& l) : led(l) {}
+
+    void blink(uint32_t interval_ms, TimerWheel& wheel) {
+        timer.stop();
+        led.stopBlink();
+        timer.onExpire([this]() { led.toggle(); });
+        wheel.every(timer, interval_ms);
+    }
+
+    void stopBlink() {
+        timer.stop();
+    }
+
+    void on() {
+        timer.stop();
+        led.on();
+    }
+
+    void off() {
+        timer.stop();
+        led.off();
+    }
+
+    void write(bool state) {
+        state ? on() : off();
+    }
+
+    bool isBlinking() const {
+        return timer.isActive();
+    }
+
+private:
+    LED& led;
+    SoftTimer timer;
+};
+
+// ==================== WHEEL BUTTON ====================
+class WheelButton {
+public:
+    explicit WheelButton(Button& b)
+        : button(b), state(false), press_event(false), release_event(false) {}
+
+    // Run the button's debounce every `sample_ms` on the wheel and latch
+    // its edges for pressed()/released()
+    void attach(TimerWheel& wheel, uint16_t sample_ms = BUTTON_SAMPLE_MS) {
+        timer.stop();
+        state = button.read();
+        press_event = false;
+        release_event = false;
+        timer.onExpire([this]() { sample(); });
+        wheel.every(timer, sample_ms ? sample_ms : 1);
+    }
+
+    void detach() {
+        timer.stop();
+    }
+
+    bool pressed() {
+        return press_event.exchange(false);
+    }
+
+    bool released() {
+        return release_event.exchange(false);
+    }
+
+    bool isPressed() const {
+        return state;
+    }
+
+    bool isAttached() const {
+        return timer.isActive();
+    }
+
+private:
+    Button& button;
+    SoftTimer timer;
+    std::atomic<bool> state;
+    std::atomic<bool> press_event;
+    std::atomic<bool> release_event;
+
+    void sample() {
+        bool reading = button.read();
+        if (reading == state) return;
+
+        state = reading;
+        if (reading) press_event = true;
+        else release_event = true;
+    }
+};
+
+#endif
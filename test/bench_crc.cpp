@@ -0,0 +1,36 @@
+// CRC-16/MODBUS throughput of the bitwise, table and slicing-by-4 forms
+// on Modbus RTU frame sizes.
+
+#include "ArduLiteESP_MODBUS.h"
+#include "host_test.h"
+
+#include <chrono>
+
+typedef uint16_t (*CRCFunction)(const uint8_t*, uint16_t, uint16_t);
+
+static double nsPerFrame(CRCFunction function, const uint8_t* data, uint16_t length) {
+    const int iterations = 200000;
+    volatile uint16_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        sink = sink + function(data, length, ModbusCRC16::INIT);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+void main() {
+    static const uint16_t sizes[] = { 8, 16, 64, 128, 256 };
+    uint8_t frame[256];
+    for (size_t i = 0; i < sizeof(frame); i++) frame[i] = (uint8_t)(i * 31 + 7);
+
+    printf("%8s %12s %12s %12s   (ns per frame)\n", "bytes", "bitwise", "table", "slice4");
+    for (uint16_t size : sizes) {
+        printf("%8u %12.1f %12.1f %12.1f\n", size,
+               nsPerFrame(ModbusCRC16::computeBitwise, frame, size),
+               nsPerFrame(ModbusCRC16::compute, frame, size),
+               nsPerFrame(ModbusCRC16::computeSlice4, frame, size));
+    }
+}
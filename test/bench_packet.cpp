@@ -0,0 +1,66 @@
+// Packet encode/decode throughput, and the samples per second a link
+// carries as COBS frames versus as ASCII lines.
+
+#include "ArduLiteESP_Packet.h"
+#include "host_test.h"
+
+#include <chrono>
+
+struct __attribute__((packed)) Sample {
+    uint32_t time;
+    int16_t ax, ay, az;
+};
+
+static uint32_t sink = 0;
+
+static double nsPer(int iterations, const std::chrono::steady_clock::time_point& start) {
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+static void measure(size_t length) {
+    const int iterations = 200000;
+    uint8_t payload[PACKET_MAX_PAYLOAD];
+    for (size_t i = 0; i < length; i++) payload[i] = (uint8_t)(i * 37);  // Includes zeros
+
+    uint8_t frame[COBS_MAX_ENCODED_SIZE(PACKET_MAX_PAYLOAD + PACKET_OVERHEAD)];
+    size_t frame_length = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        payload[0] = (uint8_t)i;
+        frame_length = packet_encode(1, payload, length, frame);
+        sink += frame[frame_length / 2];
+    }
+    double encode_ns = nsPer(iterations, start);
+
+    PacketDecoder<PACKET_MAX_PAYLOAD> decoder;
+    decoder.setHandler([](uint8_t type, const uint8_t* data, size_t count) {
+        sink += type + count;
+    });
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) decoder.feed(frame, frame_length);
+    double decode_ns = nsPer(iterations, start);
+
+    printf("%8zu %8zu %10.1f %10.1f %10.1f %10.1f\n", length, frame_length,
+           encode_ns, length * 1e3 / encode_ns, decode_ns, length * 1e3 / decode_ns);
+}
+
+void main() {
+    printf("%8s %8s %10s %10s %10s %10s\n",
+           "payload", "frame", "enc ns", "enc MB/s", "dec ns", "dec MB/s");
+    static const size_t sizes[] = { 10, 32, 64, 128 };
+    for (size_t size : sizes) measure(size);
+
+    // Wire cost of one Sample at 921600 baud (10 bits per byte)
+    Sample sample = { 123456789, -16384, 512, 16000 };
+    uint8_t frame[COBS_MAX_ENCODED_SIZE(sizeof(Sample) + PACKET_OVERHEAD)];
+    size_t binary = packet_encode(1, &sample, sizeof(sample), frame);
+    char line[64];
+    int ascii = snprintf(line, sizeof(line), "%lu,%d,%d,%d\r\n", (unsigned long)sample.time,
+                         sample.ax, sample.ay, sample.az);
+    printf("\nSample at 921600 baud: binary %zu bytes (%.0f/s), ASCII %d bytes (%.0f/s)\n",
+           binary, 92160.0 / binary, ascii, 92160.0 / ascii);
+
+    if (sink == 0) printf("\n");
+}
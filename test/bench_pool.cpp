@@ -0,0 +1,58 @@
+// WorkerPool speed-up on a 16-tap FIR over one million samples with
+// 1, 2, 4 and one-per-hardware-thread workers, against a plain loop.
+
+#include "ArduLiteESP_Core.h"
+#include "ArduLiteESP_Pool.h"
+#include "host_test.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static const size_t SAMPLES = 1 << 20;
+static const int TAPS = 16;
+static const int ROUNDS = 10;
+
+static std::vector<float> input(SAMPLES + TAPS);
+static std::vector<float> output(SAMPLES);
+static float taps[TAPS];
+
+static void fir(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        float acc = 0;
+        for (int t = 0; t < TAPS; t++) acc += taps[t] * input[i + t];
+        output[i] = acc;
+    }
+}
+
+static double msPerRound(const std::chrono::steady_clock::time_point& start) {
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / ROUNDS;
+}
+
+void main() {
+    for (size_t i = 0; i < input.size(); i++) input[i] = (float)((i * 7919) % 1000) / 1000.0f;
+    for (int t = 0; t < TAPS; t++) taps[t] = 1.0f / TAPS;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; r++) fir(0, SAMPLES);
+    double serial_ms = msPerRound(start);
+    printf("%-10s %8.2f ms\n", "loop", serial_ms);
+
+    unsigned hardware = std::thread::hardware_concurrency();
+    const unsigned counts[] = { 1, 2, 4, hardware };
+    for (unsigned workers : counts) {
+        if (workers == 0 || workers > WORK_POOL_MAX_WORKERS) continue;
+        WorkerPool pool;
+        pool.begin((uint8_t)workers);
+
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < ROUNDS; r++) pool.parallel_for(0, SAMPLES, fir);
+        double ms = msPerRound(start);
+
+        char name[16];
+        snprintf(name, sizeof(name), "%u worker%s", workers, workers == 1 ? "" : "s");
+        printf("%-10s %8.2f ms  x%.2f\n", name, ms, serial_ms / ms);
+    }
+    printf("(%u hardware threads)\n", hardware);
+}
@@ -0,0 +1,120 @@
+// Ring buffer throughput in millions of items per second: SPSCRing and
+// MPSCRing against a FreeRTOS queue (a mutex-based shim on the host).
+
+#include "ArduLiteESP_Core.h"
+#include "ArduLiteESP_Ring.h"
+#include "freertos/queue.h"
+#include "host_test.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static const uint32_t ITEMS = 20000000;
+
+static SPSCRing<uint32_t, 1024> spsc;
+static MPSCRing<uint32_t, 1024> mpsc;
+
+static double mops(const std::chrono::steady_clock::time_point& start, uint32_t items) {
+    auto end = std::chrono::steady_clock::now();
+    return items / std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static void spscSingleThread() {
+    uint32_t value = 0, sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < ITEMS; i++) {
+        spsc.push(i);
+        spsc.pop(value);
+        sum += value;
+    }
+    printf("%-34s %8.1f Mops/s\n", "SPSC push+pop, one thread", mops(start, ITEMS));
+    if (sum == 1) printf("\n");
+}
+
+static void spscTwoThreads() {
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([]() {
+        for (uint32_t i = 0; i < ITEMS;) {
+            if (spsc.push(i)) i++;
+            else std::this_thread::yield();
+        }
+    });
+    uint32_t value;
+    for (uint32_t received = 0; received < ITEMS;) {
+        if (spsc.pop(value)) received++;
+        else std::this_thread::yield();
+    }
+    producer.join();
+    printf("%-34s %8.1f Mops/s\n", "SPSC producer -> consumer", mops(start, ITEMS));
+}
+
+static void spscBulk() {
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([]() {
+        uint32_t block[64];
+        for (uint32_t i = 0; i < ITEMS;) {
+            for (uint32_t j = 0; j < 64; j++) block[j] = i + j;
+            size_t written = spsc.write(block, ITEMS - i < 64 ? ITEMS - i : 64);
+            if (written == 0) std::this_thread::yield();
+            i += written;
+        }
+    });
+    uint32_t block[64];
+    for (uint32_t received = 0; received < ITEMS;) {
+        size_t count = spsc.read(block, 64);
+        if (count == 0) std::this_thread::yield();
+        received += count;
+    }
+    producer.join();
+    printf("%-34s %8.1f Mops/s\n", "SPSC write/read, 64-item blocks", mops(start, ITEMS));
+}
+
+static void mpscProducers(int producers) {
+    uint32_t per_producer = ITEMS / producers;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([per_producer]() {
+            for (uint32_t i = 0; i < per_producer;) {
+                if (mpsc.push(i)) i++;
+                else std::this_thread::yield();
+            }
+        });
+    }
+    uint32_t value;
+    for (uint32_t received = 0; received < per_producer * producers;) {
+        if (mpsc.pop(value)) received++;
+        else std::this_thread::yield();
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    char name[48];
+    snprintf(name, sizeof(name), "MPSC %d producer(s) -> consumer", producers);
+    printf("%-34s %8.1f Mops/s\n", name, mops(start, per_producer * producers));
+}
+
+static void freertosQueue() {
+    const uint32_t items = ITEMS / 20;
+    static QueueHandle_t queue = xQueueCreate(1024, sizeof(uint32_t));
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([items]() {
+        for (uint32_t i = 0; i < items; i++) xQueueSend(queue, &i, portMAX_DELAY);
+    });
+    uint32_t value;
+    for (uint32_t received = 0; received < items; received++) {
+        xQueueReceive(queue, &value, portMAX_DELAY);
+    }
+    producer.join();
+    printf("%-34s %8.1f Mops/s\n", "xQueue producer -> consumer", mops(start, items));
+}
+
+void main() {
+    spscSingleThread();
+    spscTwoThreads();
+    spscBulk();
+    mpscProducers(1);
+    mpscProducers(2);
+    mpscProducers(4);
+    freertosQueue();
+}
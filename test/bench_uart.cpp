@@ -0,0 +1,85 @@
+// UART receive throughput and CPU use: the RX task's chunked reads with
+// memchr line splitting against one driver read per byte, the path the
+// RX task used to take.
+
+#include "ArduLiteESP_UART.h"
+#include "host_test.h"
+
+#include <atomic>
+#include <time.h>
+
+static const size_t LINE_LENGTH = 40;       // Including '\n'
+static const size_t TOTAL_BYTES = 8 << 20;
+static const size_t BURST_BYTES = 480;      // Stays under the driver RX buffer
+
+static std::atomic<size_t> received_bytes(0);
+
+static double seconds(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Feed the port in bursts the consumer keeps up with, then report the
+// consumer's throughput and CPU use (process time minus the feeder's own)
+static void feed(const char* name, const char* burst, const std::atomic<size_t>& consumed) {
+    double wall = seconds(CLOCK_MONOTONIC);
+    double cpu = seconds(CLOCK_PROCESS_CPUTIME_ID) - seconds(CLOCK_THREAD_CPUTIME_ID);
+
+    for (size_t sent = 0; sent < TOTAL_BYTES; sent += BURST_BYTES) {
+        while (sent - consumed.load() > UART::UART_DRIVER_BUF_SIZE - BURST_BYTES) taskYIELD();
+        host_uart_inject(UART_NUM_1, burst, BURST_BYTES);
+    }
+    while (consumed.load() < TOTAL_BYTES) taskYIELD();
+
+    wall = seconds(CLOCK_MONOTONIC) - wall;
+    cpu = seconds(CLOCK_PROCESS_CPUTIME_ID) - seconds(CLOCK_THREAD_CPUTIME_ID) - cpu;
+    printf("%-20s %8.1f MB/s %8.1f ns CPU/byte %6.1f %% of a core\n", name,
+           TOTAL_BYTES / wall / 1e6, cpu * 1e9 / TOTAL_BYTES, 100.0 * cpu / wall);
+}
+
+void main() {
+    static char burst[BURST_BYTES];
+    for (size_t i = 0; i < BURST_BYTES; i++) {
+        burst[i] = (i % LINE_LENGTH == LINE_LENGTH - 1) ? '\n' : (char)('a' + i % 26);
+    }
+
+    {
+        UART port(UART_NUM_1);
+        port.onLine([](const char*, size_t length) {
+            received_bytes += length + 1;
+        });
+        port.begin(921600);
+
+        feed("chunked + memchr", burst, received_bytes);
+    }
+
+    {
+        static std::atomic<size_t> read_bytes(0);
+        UART port(UART_NUM_1);
+        port.begin(921600);
+
+        TaskHandle_t reader;
+        xTaskCreate([](void* param) {
+            UART* port = (UART*)param;
+            char line[LINE_LENGTH];
+            size_t length = 0;
+            while (true) {
+                int c = port->read();
+                if (c < 0) {
+                    taskYIELD();
+                    continue;
+                }
+                if (c == '\n') {
+                    read_bytes += length + 1;
+                    length = 0;
+                } else if (length < sizeof(line) - 1) {
+                    line[length++] = (char)c;
+                }
+            }
+        }, "reader", 4096, &port, 5, &reader);
+
+        feed("one read per byte", burst, read_bytes);
+        vTaskDelete(reader);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+// Minimal test runner for the host build. Each test_*.cpp is one
+// executable: TEST() bodies run in order from main() (app_main() on the
+// simulated chip) and the process exits non-zero if any CHECK failed.
+//
+//   TEST(crc_matches_reference) {
+//       CHECK_EQ(crc16(frame, 6), 0x0BC4);
+//   }
+//
+//   void main() {
+//       host_run_tests();
+//   }
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "host_idf.h"
+
+extern "C" void app_main(void);
+
+struct HostTest {
+    const char* name;
+    void (*function)();
+    HostTest* next;
+};
+
+struct HostTestState {
+    HostTest* first = nullptr;
+    HostTest* last = nullptr;
+    int failures = 0;
+};
+
+inline HostTestState& host_test_state() {
+    static HostTestState state;
+    return state;
+}
+
+struct HostTestRegistrar {
+    HostTest test;
+
+    HostTestRegistrar(const char* name, void (*function)()) : test{name, function, nullptr} {
+        HostTestState& state = host_test_state();
+        if (state.last) state.last->next = &test;
+        else state.first = &test;
+        state.last = &test;
+    }
+};
+
+#define TEST(name) \
+    static void test_##name(); \
+    static HostTestRegistrar test_registrar_##name(#name, test_##name); \
+    static void test_##name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            host_test_state().failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        long long actual_value = (long long)(actual); \
+        long long expected_value = (long long)(expected); \
+        if (actual_value != expected_value) { \
+            printf("  %s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, \
+                   #actual, #expected, actual_value, expected_value); \
+            host_test_state().failures++; \
+        } \
+    } while (0)
+
+#define CHECK_STR(actual, expected) \
+    do { \
+        const char* actual_value = (actual); \
+        const char* expected_value = (expected); \
+        if (strcmp(actual_value, expected_value) != 0) { \
+            printf("  %s:%d: CHECK_STR(%s, %s) failed: \"%s\" != \"%s\"\n", __FILE__, \
+                   __LINE__, #actual, #expected, actual_value, expected_value); \
+            host_test_state().failures++; \
+        } \
+    } while (0)
+
+inline int host_run_tests() {
+    HostTestState& state = host_test_state();
+    int run = 0;
+    int failed = 0;
+
+    for (HostTest* test = state.first; test; test = test->next) {
+        int before = state.failures;
+        printf("[ RUN  ] %s\n", test->name);
+        test->function();
+        bool ok = state.failures == before;
+        printf("[ %s ] %s\n", ok ? " OK " : "FAIL", test->name);
+        run++;
+        if (!ok) failed++;
+    }
+
+    printf("%d tests, %d failed\n", run, failed);
+    host_set_exit_code(failed ? 1 : 0);
+    return failed;
+}
+
+#endif
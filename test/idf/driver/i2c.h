@@ -0,0 +1,81 @@
+#ifndef HOST_DRIVER_I2C_H
+#define HOST_DRIVER_I2C_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+
+typedef int i2c_port_t;
+
+#define I2C_NUM_0       0
+#define I2C_NUM_1       1
+#define I2C_NUM_MAX     2
+
+typedef enum {
+    I2C_MODE_SLAVE = 0,
+    I2C_MODE_MASTER
+} i2c_mode_t;
+
+typedef enum {
+    I2C_MASTER_WRITE = 0,
+    I2C_MASTER_READ
+} i2c_rw_t;
+
+typedef enum {
+    I2C_MASTER_ACK = 0,
+    I2C_MASTER_NACK,
+    I2C_MASTER_LAST_NACK
+} i2c_ack_type_t;
+
+typedef struct {
+    i2c_mode_t mode;
+    int        sda_io_num;
+    int        scl_io_num;
+    bool       sda_pullup_en;
+    bool       scl_pullup_en;
+    union {
+        struct {
+            uint32_t clk_speed;
+        } master;
+        struct {
+            uint8_t  addr_10bit_en;
+            uint16_t slave_addr;
+            uint32_t maximum_speed;
+        } slave;
+    };
+    uint32_t   clk_flags;
+} i2c_config_t;
+
+typedef void* i2c_cmd_handle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t* config);
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t slave_rx_buf_len,
+                             size_t slave_tx_buf_len, int flags);
+esp_err_t i2c_driver_delete(i2c_port_t port);
+
+i2c_cmd_handle_t i2c_cmd_link_create(void);
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t* data, size_t length, bool ack_en);
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd, uint8_t* data, i2c_ack_type_t ack);
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t* data, size_t length, i2c_ack_type_t ack);
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks);
+
+int i2c_slave_read_buffer(i2c_port_t port, uint8_t* data, size_t max_length, TickType_t ticks);
+int i2c_slave_write_buffer(i2c_port_t port, const uint8_t* data, int length, TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef HOST_ESP_ADC_CAL_H
+#define HOST_ESP_ADC_CAL_H
+
+#include "driver/adc.h"
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// Host stand-in for the FreeRTOS kernel headers: just the types and
+// macros the library uses, backed by threads in host_idf.cpp.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "esp_err.h"
+
+// newlib extensions that the ESP toolchain declares in <stdlib.h>
+char* itoa(int value, char* str, int base);
+char* utoa(unsigned value, char* str, int base);
+
+typedef uint32_t     TickType_t;
+typedef int          BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t      StackType_t;
+
+#define configTICK_RATE_HZ                  1000
+#define configGENERATE_RUN_TIME_STATS       1
+#define configUSE_TRACE_FACILITY            1
+
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFUL)
+#define portNUM_PROCESSORS  2
+
+#define pdFALSE             0
+#define pdTRUE              1
+#define pdFAIL              0
+#define pdPASS              1
+
+#define tskNO_AFFINITY      0x7FFFFFFF
+#define IRAM_ATTR
+
+#define portYIELD_FROM_ISR(woken)   ((void)(woken))
+
+// Critical sections share one recursive host lock
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { 0, 0 }
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void host_enter_critical(portMUX_TYPE* mux);
+void host_exit_critical(portMUX_TYPE* mux);
+void ets_delay_us(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define portENTER_CRITICAL(mux)         host_enter_critical(mux)
+#define portEXIT_CRITICAL(mux)          host_exit_critical(mux)
+#define portENTER_CRITICAL_ISR(mux)     host_enter_critical(mux)
+#define portEXIT_CRITICAL_ISR(mux)      host_exit_critical(mux)
+#define taskENTER_CRITICAL(mux)         host_enter_critical(mux)
+#define taskEXIT_CRITICAL(mux)          host_exit_critical(mux)
+
+#endif
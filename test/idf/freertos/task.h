@@ -0,0 +1,78 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// Storage for xTaskCreateStatic(); the host keeps its own bookkeeping
+typedef struct {
+    void* reserved[4];
+} StaticTask_t;
+
+typedef enum {
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+typedef struct {
+    TaskHandle_t xHandle;
+    const char*  pcTaskName;
+    UBaseType_t  xTaskNumber;
+    eTaskState   eCurrentState;
+    UBaseType_t  uxCurrentPriority;
+    UBaseType_t  uxBasePriority;
+    uint32_t     ulRunTimeCounter;
+    StackType_t* pxStackBase;
+    uint32_t     usStackHighWaterMark;
+    BaseType_t   xCoreID;
+} TaskStatus_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name,
+                                   uint32_t stack_depth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* created,
+                                   BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name,
+                       uint32_t stack_depth, void* param,
+                       UBaseType_t priority, TaskHandle_t* created);
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t function, const char* name,
+                                           uint32_t stack_depth, void* param,
+                                           UBaseType_t priority, StackType_t* stack,
+                                           StaticTask_t* tcb, BaseType_t core);
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function, const char* name,
+                               uint32_t stack_depth, void* param,
+                               UBaseType_t priority, StackType_t* stack,
+                               StaticTask_t* tcb);
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previous_wake, TickType_t period);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+void taskYIELD(void);
+
+void vTaskSuspend(TaskHandle_t task);
+void vTaskResume(TaskHandle_t task);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_woken);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void vTaskGetInfo(TaskHandle_t task, TaskStatus_t* status,
+                  BaseType_t get_high_water_mark, eTaskState state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
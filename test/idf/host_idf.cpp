@@ -0,0 +1,1394 @@
+// Host implementation of the FreeRTOS / ESP-IDF subset the library uses.
+//
+// Tasks are detached std::threads. Every kernel object (notifications,
+// queues, semaphores, driver buffers) is guarded by one lock and one
+// condition variable, so any state change wakes every waiter and each
+// re-checks its own condition. This is slow next to the real kernel but
+// simple enough to trust; priorities and core affinity are ignored.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "soc/gpio_struct.h"
+#include "driver/gpio.h"
+#include "driver/uart.h"
+#include "driver/i2c.h"
+#include "driver/ledc.h"
+#include "driver/adc.h"
+#include "esp_timer.h"
+#include "host_idf.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+gpio_dev_t GPIO;
+
+// ==================== LIBC ====================
+
+char* utoa(unsigned value, char* str, int base) {
+    char digits[33];
+    int n = 0;
+    do {
+        unsigned d = value % base;
+        digits[n++] = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+        value /= base;
+    } while (value);
+
+    for (int i = 0; i < n; i++) str[i] = digits[n - 1 - i];
+    str[n] = '\0';
+    return str;
+}
+
+char* itoa(int value, char* str, int base) {
+    if (value < 0 && base == 10) {
+        str[0] = '-';
+        utoa(0u - (unsigned)value, str + 1, base);
+        return str;
+    }
+    return utoa((unsigned)value, str, base);
+}
+
+extern "C" void app_main(void);
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Lock = std::unique_lock<std::mutex>;
+
+std::mutex kernel_lock;
+std::condition_variable kernel_changed;
+std::recursive_mutex critical_lock;
+
+// ==================== CLOCK ====================
+const Clock::time_point boot_time = Clock::now();
+std::atomic<int64_t> clock_offset_us(0);
+
+int64_t real_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - boot_time).count();
+}
+
+Clock::time_point deadline_after(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) return Clock::time_point::max();
+    return Clock::now() + std::chrono::microseconds((int64_t)ticks * 1000000 / configTICK_RATE_HZ);
+}
+
+// ==================== TASKS ====================
+struct TaskExit {};
+
+}  // namespace
+
+struct host_task {
+    TaskFunction_t function;
+    void*          param;
+    std::string    name;
+    uint32_t       stack_depth;
+    UBaseType_t    priority;
+    pthread_t      thread;
+    uint32_t       notify_count;
+    uint32_t       runtime_offset;
+    bool           deleted;
+    bool           suspended;
+    bool           finished;
+};
+
+namespace {
+
+thread_local host_task* current_task = nullptr;
+
+// Block on the kernel condition until `ready()` or the timeout. A task
+// deleted by another task unwinds out of here.
+template<typename Ready>
+bool kernel_wait(Lock& lock, TickType_t ticks, Ready ready) {
+    Clock::time_point deadline = deadline_after(ticks);
+
+    while (true) {
+        if (current_task && current_task->deleted) throw TaskExit();
+        if (ready()) return true;
+        if (ticks == 0) return false;
+
+        if (deadline == Clock::time_point::max()) {
+            kernel_changed.wait(lock);
+        } else if (kernel_changed.wait_until(lock, deadline) == std::cv_status::timeout) {
+            if (current_task && current_task->deleted) throw TaskExit();
+            return ready();
+        }
+    }
+}
+
+void* task_trampoline(void* arg) {
+    host_task* task = (host_task*)arg;
+    current_task = task;
+
+    try {
+        task->function(task->param);
+    } catch (const TaskExit&) {
+    }
+
+    Lock lock(kernel_lock);
+    task->finished = true;
+    kernel_changed.notify_all();
+    return nullptr;
+}
+
+host_task* start_task(TaskFunction_t function, const char* name, uint32_t stack_depth,
+                      void* param, UBaseType_t priority) {
+    host_task* task = new host_task();
+    task->function = function;
+    task->param = param;
+    task->name = name ? name : "";
+    task->stack_depth = stack_depth;
+    task->priority = priority;
+    task->notify_count = 0;
+    task->runtime_offset = 0;
+    task->deleted = false;
+    task->suspended = false;
+    task->finished = false;
+
+    // Hold the lock so the new task cannot be deleted before it is detached
+    Lock lock(kernel_lock);
+    if (pthread_create(&task->thread, nullptr, task_trampoline, task) != 0) {
+        delete task;
+        return nullptr;
+    }
+    pthread_detach(task->thread);
+    return task;
+}
+
+int exit_code = 0;
+
+}  // namespace
+
+extern "C" {
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name,
+                                   uint32_t stack_depth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* created,
+                                   BaseType_t core) {
+    (void)core;
+    host_task* task = start_task(function, name, stack_depth, param, priority);
+    if (created) *created = task;
+    return task ? pdPASS : pdFAIL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name,
+                       uint32_t stack_depth, void* param,
+                       UBaseType_t priority, TaskHandle_t* created) {
+    return xTaskCreatePinnedToCore(function, name, stack_depth, param, priority,
+                                   created, tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t function, const char* name,
+                                           uint32_t stack_depth, void* param,
+                                           UBaseType_t priority, StackType_t* stack,
+                                           StaticTask_t* tcb, BaseType_t core) {
+    (void)core;
+    if (!stack || !tcb) return nullptr;
+    return start_task(function, name, stack_depth, param, priority);
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function, const char* name,
+                               uint32_t stack_depth, void* param,
+                               UBaseType_t priority, StackType_t* stack,
+                               StaticTask_t* tcb) {
+    return xTaskCreateStaticPinnedToCore(function, name, stack_depth, param, priority,
+                                         stack, tcb, tskNO_AFFINITY);
+}
+
+// Deleting another task waits (up to a second) for it to reach a kernel
+// call and unwind; a task spinning without one is abandoned
+void vTaskDelete(TaskHandle_t task) {
+    if (!task || task == current_task) {
+        if (current_task) throw TaskExit();
+        return;
+    }
+
+    Lock lock(kernel_lock);
+    task->deleted = true;
+    kernel_changed.notify_all();
+    bool finished = kernel_changed.wait_for(lock, std::chrono::seconds(1),
+                                            [task]() { return task->finished; });
+    if (finished) delete task;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        std::this_thread::yield();
+        return;
+    }
+    Lock lock(kernel_lock);
+    kernel_wait(lock, ticks, []() { return false; });
+}
+
+void vTaskDelayUntil(TickType_t* previous_wake, TickType_t period) {
+    *previous_wake += period;
+    int32_t remaining = (int32_t)(*previous_wake - xTaskGetTickCount());
+    if (remaining > 0) vTaskDelay((TickType_t)remaining);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / (1000000 / configTICK_RATE_HZ));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return current_task;
+}
+
+void taskYIELD(void) {
+    std::this_thread::yield();
+}
+
+void vTaskSuspend(TaskHandle_t task) {
+    Lock lock(kernel_lock);
+    host_task* target = task ? task : current_task;
+    if (!target) return;
+    target->suspended = true;
+    if (target == current_task) {
+        kernel_wait(lock, portMAX_DELAY, [target]() { return !target->suspended; });
+    }
+}
+
+void vTaskResume(TaskHandle_t task) {
+    Lock lock(kernel_lock);
+    if (!task) return;
+    task->suspended = false;
+    kernel_changed.notify_all();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    Lock lock(kernel_lock);
+    task->notify_count++;
+    kernel_changed.notify_all();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_woken) {
+    xTaskNotifyGive(task);
+    if (higher_priority_woken) *higher_priority_woken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    host_task* task = current_task;
+    if (!task) return 0;
+
+    Lock lock(kernel_lock);
+    if (!kernel_wait(lock, ticks, [task]() { return task->notify_count > 0; })) return 0;
+
+    uint32_t value = task->notify_count;
+    task->notify_count = clear_on_exit ? 0 : value - 1;
+    return value;
+}
+
+// No stack is used from the buffer, so all of it is always free
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    host_task* target = task ? task : current_task;
+    return target ? target->stack_depth : 0;
+}
+
+void vTaskGetInfo(TaskHandle_t task, TaskStatus_t* status,
+                  BaseType_t get_high_water_mark, eTaskState state) {
+    (void)state;
+    host_task* target = task ? task : current_task;
+    memset(status, 0, sizeof(*status));
+    if (!target) return;
+
+    Lock lock(kernel_lock);
+    uint64_t cpu_us = 0;
+    clockid_t cpu_clock;
+    struct timespec ts;
+    if (!target->finished && pthread_getcpuclockid(target->thread, &cpu_clock) == 0 &&
+        clock_gettime(cpu_clock, &ts) == 0) {
+        cpu_us = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+
+    status->xHandle = target;
+    status->pcTaskName = target->name.c_str();
+    status->eCurrentState = target->finished ? eDeleted
+                          : target->suspended ? eSuspended
+                          : target == current_task ? eRunning : eReady;
+    status->uxCurrentPriority = target->priority;
+    status->uxBasePriority = target->priority;
+    status->ulRunTimeCounter = (uint32_t)cpu_us + target->runtime_offset;
+    status->usStackHighWaterMark = get_high_water_mark ? target->stack_depth : 0;
+    status->xCoreID = tskNO_AFFINITY;
+}
+
+void host_task_add_runtime(TaskHandle_t task, uint32_t offset_us) {
+    Lock lock(kernel_lock);
+    host_task* target = task ? task : current_task;
+    if (target) target->runtime_offset += offset_us;
+}
+
+void host_enter_critical(portMUX_TYPE* mux) {
+    critical_lock.lock();
+    mux->count++;
+}
+
+void host_exit_critical(portMUX_TYPE* mux) {
+    mux->count--;
+    critical_lock.unlock();
+}
+
+void ets_delay_us(uint32_t us) {
+    Clock::time_point until = Clock::now() + std::chrono::microseconds(us);
+    while (Clock::now() < until) {
+    }
+}
+
+void host_set_exit_code(int code) {
+    exit_code = code;
+}
+
+}  // extern "C"
+
+// ==================== QUEUES AND SEMAPHORES ====================
+struct host_queue {
+    UBaseType_t length;
+    UBaseType_t item_size;      // 0 for semaphores: only the count matters
+    std::deque<std::vector<uint8_t>> items;
+};
+
+namespace {
+
+host_queue* create_queue(UBaseType_t length, UBaseType_t item_size, UBaseType_t initial) {
+    host_queue* queue = new host_queue();
+    queue->length = length;
+    queue->item_size = item_size;
+    for (UBaseType_t i = 0; i < initial; i++) queue->items.emplace_back();
+    return queue;
+}
+
+// Caller holds kernel_lock
+bool queue_push(host_queue* queue, const void* item) {
+    if (queue->items.size() >= queue->length) return false;
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.emplace_back(bytes, bytes + (item ? queue->item_size : 0));
+    kernel_changed.notify_all();
+    return true;
+}
+
+}  // namespace
+
+extern "C" {
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    return create_queue(length, item_size, 0);
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    Lock lock(kernel_lock);
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    Lock lock(kernel_lock);
+    if (!kernel_wait(lock, ticks, [queue]() { return queue->items.size() < queue->length; })) {
+        return pdFALSE;
+    }
+    return queue_push(queue, item) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item,
+                             BaseType_t* higher_priority_woken) {
+    if (higher_priority_woken) *higher_priority_woken = pdFALSE;
+    Lock lock(kernel_lock);
+    return queue_push(queue, item) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    Lock lock(kernel_lock);
+    if (!kernel_wait(lock, ticks, [queue]() { return !queue->items.empty(); })) return pdFALSE;
+
+    if (item && queue->item_size) memcpy(item, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    kernel_changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    Lock lock(kernel_lock);
+    queue->items.clear();
+    kernel_changed.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    Lock lock(kernel_lock);
+    return (UBaseType_t)queue->items.size();
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return create_queue(1, 0, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buffer) {
+    return buffer ? create_queue(1, 0, 0) : nullptr;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    return create_queue(max_count, 0, initial_count);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return create_queue(1, 0, 1);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    Lock lock(kernel_lock);
+    return queue_push(semaphore, nullptr) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore,
+                                 BaseType_t* higher_priority_woken) {
+    return xQueueSendFromISR(semaphore, nullptr, higher_priority_woken);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    return xQueueReceive(semaphore, nullptr, ticks);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    vQueueDelete(semaphore);
+}
+
+}  // extern "C"
+
+// ==================== ESP TIMER ====================
+// Each started timer runs its callbacks on its own thread, in real time
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void*          arg;
+    uint64_t       period_us;       // 0 for one-shot
+    uint32_t       generation;      // Bumped by stop() to retire the thread
+    bool           running;
+    bool           firing;
+    std::thread::id thread;
+};
+
+namespace {
+
+void timer_thread(esp_timer* timer, uint32_t generation, uint64_t first_us) {
+    Lock lock(kernel_lock);
+    Clock::time_point next = Clock::now() + std::chrono::microseconds(first_us);
+
+    while (true) {
+        kernel_changed.wait_until(lock, next, [timer, generation]() {
+            return timer->generation != generation;
+        });
+        if (timer->generation != generation) break;
+        if (Clock::now() < next) continue;
+
+        timer->firing = true;
+        lock.unlock();
+        timer->callback(timer->arg);
+        lock.lock();
+        timer->firing = false;
+        kernel_changed.notify_all();
+
+        if (timer->generation != generation) break;
+        if (!timer->period_us) {
+            timer->running = false;
+            break;
+        }
+        next += std::chrono::microseconds(timer->period_us);
+    }
+}
+
+esp_err_t timer_start(esp_timer_handle_t timer, uint64_t period_us, uint64_t first_us) {
+    Lock lock(kernel_lock);
+    if (timer->running) return ESP_ERR_INVALID_STATE;
+    timer->running = true;
+    timer->period_us = period_us;
+    std::thread thread(timer_thread, timer, timer->generation, first_us);
+    timer->thread = thread.get_id();
+    thread.detach();
+    return ESP_OK;
+}
+
+}  // namespace
+
+extern "C" {
+
+int64_t esp_timer_get_time(void) {
+    return real_us() + clock_offset_us.load(std::memory_order_relaxed);
+}
+
+void host_clock_advance_us(int64_t us) {
+    clock_offset_us.fetch_add(us, std::memory_order_relaxed);
+}
+
+void host_clock_set_us(int64_t us) {
+    clock_offset_us.store(us - real_us(), std::memory_order_relaxed);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* timer) {
+    if (!args || !args->callback || !timer) return ESP_ERR_INVALID_ARG;
+    esp_timer* created = new esp_timer();
+    created->callback = args->callback;
+    created->arg = args->arg;
+    created->period_us = 0;
+    created->generation = 0;
+    created->running = false;
+    created->firing = false;
+    *timer = created;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    return timer_start(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return timer_start(timer, 0, timeout_us);
+}
+
+// Like esp_timer_stop(), a callback already running is not waited for
+// when stopping from inside it
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    Lock lock(kernel_lock);
+    if (!timer->running) return ESP_ERR_INVALID_STATE;
+    timer->running = false;
+    timer->generation++;
+    kernel_changed.notify_all();
+    if (timer->thread != std::this_thread::get_id()) {
+        kernel_changed.wait(lock, [timer]() { return !timer->firing; });
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    {
+        Lock lock(kernel_lock);
+        if (timer->running) return ESP_ERR_INVALID_STATE;
+        if (timer->firing) return ESP_OK;   // Leaked rather than freed under its thread
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+}  // extern "C"
+
+// ==================== GPIO ====================
+namespace {
+
+struct PinState {
+    int8_t          pull;
+    gpio_int_type_t intr_type;
+    bool            intr_enabled;
+    gpio_isr_t      handler;
+    void*           handler_arg;
+};
+
+PinState pins[GPIO_NUM_MAX];
+bool isr_service_installed = false;
+
+bool valid_pin(int pin) {
+    return pin >= 0 && pin < GPIO_NUM_MAX;
+}
+
+volatile uint32_t& in_register(uint8_t pin) {
+    return pin < 32 ? GPIO.in : GPIO.in1.val;
+}
+
+esp_err_t set_pull(gpio_num_t pin, int8_t pull, bool enable) {
+    if (!valid_pin(pin)) return ESP_ERR_INVALID_ARG;
+    if (enable) pins[pin].pull = pull;
+    else if (pins[pin].pull == pull) pins[pin].pull = 0;
+    return ESP_OK;
+}
+
+}  // namespace
+
+extern "C" {
+
+esp_err_t gpio_pullup_en(gpio_num_t pin)    { return set_pull(pin, 1, true); }
+esp_err_t gpio_pullup_dis(gpio_num_t pin)   { return set_pull(pin, 1, false); }
+esp_err_t gpio_pulldown_en(gpio_num_t pin)  { return set_pull(pin, -1, true); }
+esp_err_t gpio_pulldown_dis(gpio_num_t pin) { return set_pull(pin, -1, false); }
+
+esp_err_t gpio_install_isr_service(int flags) {
+    (void)flags;
+    if (isr_service_installed) return ESP_ERR_INVALID_STATE;
+    isr_service_installed = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) {
+    if (!valid_pin(pin)) return ESP_ERR_INVALID_ARG;
+    pins[pin].intr_type = type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t handler, void* arg) {
+    if (!valid_pin(pin)) return ESP_ERR_INVALID_ARG;
+    if (!isr_service_installed) return ESP_ERR_INVALID_STATE;
+    pins[pin].handler = handler;
+    pins[pin].handler_arg = arg;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t pin) {
+    if (!valid_pin(pin)) return ESP_ERR_INVALID_ARG;
+    pins[pin].handler = nullptr;
+    pins[pin].handler_arg = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t pin) {
+    if (!valid_pin(pin)) return ESP_ERR_INVALID_ARG;
+    pins[pin].intr_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t pin) {
+    if (!valid_pin(pin)) return ESP_ERR_INVALID_ARG;
+    pins[pin].intr_enabled = false;
+    return ESP_OK;
+}
+
+void host_gpio_set_input(uint8_t pin, bool level) {
+    if (!valid_pin(pin)) return;
+
+    uint32_t mask = 1UL << (pin % 32);
+    volatile uint32_t& reg = in_register(pin);
+    bool previous = (reg & mask) != 0;
+    reg = level ? (reg | mask) : (reg & ~mask);
+
+    const PinState& state = pins[pin];
+    if (!state.handler || !state.intr_enabled) return;
+
+    bool fire = false;
+    switch (state.intr_type) {
+        case GPIO_INTR_POSEDGE:    fire = !previous && level; break;
+        case GPIO_INTR_NEGEDGE:    fire = previous && !level; break;
+        case GPIO_INTR_ANYEDGE:    fire = previous != level; break;
+        case GPIO_INTR_LOW_LEVEL:  fire = !level; break;
+        case GPIO_INTR_HIGH_LEVEL: fire = level; break;
+        default: break;
+    }
+    if (fire) state.handler(state.handler_arg);
+}
+
+bool host_gpio_get_output(uint8_t pin) {
+    if (!valid_pin(pin)) return false;
+    return pin < 32 ? (GPIO.out >> pin) & 1U : (GPIO.out1.val >> (pin - 32)) & 1U;
+}
+
+bool host_gpio_output_enabled(uint8_t pin) {
+    if (!valid_pin(pin)) return false;
+    return pin < 32 ? (GPIO.enable >> pin) & 1U : (GPIO.enable1.val >> (pin - 32)) & 1U;
+}
+
+int host_gpio_get_pull(uint8_t pin) {
+    return valid_pin(pin) ? pins[pin].pull : 0;
+}
+
+}  // extern "C"
+
+// ==================== UART ====================
+namespace {
+
+inline constexpr size_t UART_EVENT_CHUNK = 120;         // RX FIFO threshold
+inline constexpr size_t UART_TX_CAPTURE_MAX = 1 << 20;
+
+struct UartState {
+    bool                 installed;
+    uint32_t             baud;
+    uart_mode_t          mode;
+    size_t               rx_capacity;
+    QueueHandle_t        events;
+    std::deque<uint8_t>  rx;
+    uint64_t             rx_consumed;      // Bytes removed from `rx` so far
+    std::vector<uint8_t> tx;
+    int                  peer;
+    int64_t              tx_busy_until_us;
+
+    bool                 pattern_enabled;
+    char                 pattern_char;
+    uint8_t              pattern_count;
+    uint8_t              pattern_run;
+    size_t               pattern_queue_length;
+    std::deque<uint64_t> pattern_positions;  // Absolute stream offsets
+};
+
+UartState uarts[UART_NUM_MAX];
+
+bool valid_uart(uart_port_t port) {
+    return port >= 0 && port < UART_NUM_MAX;
+}
+
+void post_event(UartState& state, uart_event_type_t type, size_t size, bool timeout_flag) {
+    if (!state.events) return;
+    uart_event_t event = {};
+    event.type = type;
+    event.size = size;
+    event.timeout_flag = timeout_flag;
+    queue_push(state.events, &event);       // Lost when the queue is full, as on hardware
+}
+
+// Caller holds kernel_lock
+void receive(UartState& state, const uint8_t* data, size_t length) {
+    if (!state.installed) return;
+
+    size_t room = state.rx_capacity - state.rx.size();
+    size_t accepted = length < room ? length : room;
+
+    for (size_t i = 0; i < accepted; i++) {
+        state.rx.push_back(data[i]);
+        if (!state.pattern_enabled) continue;
+
+        if (data[i] != state.pattern_char) {
+            state.pattern_run = 0;
+            continue;
+        }
+        if (++state.pattern_run < state.pattern_count) continue;
+
+        state.pattern_run = 0;
+        uint64_t position = state.rx_consumed + state.rx.size() - state.pattern_count;
+        if (state.pattern_positions.size() < state.pattern_queue_length) {
+            state.pattern_positions.push_back(position);
+        }
+        post_event(state, UART_PATTERN_DET, 0, false);
+    }
+
+    for (size_t sent = 0; sent < accepted; sent += UART_EVENT_CHUNK) {
+        size_t chunk = accepted - sent < UART_EVENT_CHUNK ? accepted - sent : UART_EVENT_CHUNK;
+        post_event(state, UART_DATA, chunk, sent + chunk == accepted);
+    }
+
+    if (accepted < length) post_event(state, UART_BUFFER_FULL, 0, false);
+    kernel_changed.notify_all();
+}
+
+size_t consume(UartState& state, uint8_t* out, size_t length) {
+    size_t count = length < state.rx.size() ? length : state.rx.size();
+    for (size_t i = 0; i < count; i++) {
+        out[i] = state.rx.front();
+        state.rx.pop_front();
+    }
+    state.rx_consumed += count;
+    return count;
+}
+
+}  // namespace
+
+extern "C" {
+
+esp_err_t uart_driver_install(uart_port_t port, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t* queue, int flags) {
+    (void)tx_buffer_size;
+    (void)flags;
+    if (!valid_uart(port) || rx_buffer_size <= 0) return ESP_ERR_INVALID_ARG;
+
+    Lock lock(kernel_lock);
+    UartState& state = uarts[port];
+    if (state.installed) return ESP_FAIL;
+
+    state.installed = true;
+    if (!state.baud) state.baud = 115200;
+    state.rx_capacity = (size_t)rx_buffer_size;
+    state.rx.clear();
+    state.rx_consumed = 0;
+    state.tx_busy_until_us = 0;
+    state.pattern_enabled = false;
+    state.pattern_positions.clear();
+    state.events = nullptr;
+    if (queue && queue_size > 0) {
+        state.events = create_queue((UBaseType_t)queue_size, sizeof(uart_event_t), 0);
+        *queue = state.events;
+    }
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t port) {
+    if (!valid_uart(port)) return ESP_ERR_INVALID_ARG;
+
+    Lock lock(kernel_lock);
+    UartState& state = uarts[port];
+    if (!state.installed) return ESP_FAIL;
+    state.installed = false;
+    delete state.events;
+    state.events = nullptr;
+    state.rx.clear();
+    kernel_changed.notify_all();
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t* config) {
+    if (!valid_uart(port) || !config || config->baud_rate <= 0) return ESP_ERR_INVALID_ARG;
+    Lock lock(kernel_lock);
+    uarts[port].baud = (uint32_t)config->baud_rate;
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t port, int tx, int rx, int rts, int cts) {
+    (void)tx; (void)rx; (void)rts; (void)cts;
+    return valid_uart(port) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_mode(uart_port_t port, uart_mode_t mode) {
+    if (!valid_uart(port)) return ESP_ERR_INVALID_ARG;
+    Lock lock(kernel_lock);
+    uarts[port].mode = mode;
+    return ESP_OK;
+}
+
+esp_err_t uart_set_rx_timeout(uart_port_t port, uint8_t threshold) {
+    (void)threshold;
+    return valid_uart(port) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_get_baudrate(uart_port_t port, uint32_t* baudrate) {
+    if (!valid_uart(port) || !baudrate) return ESP_ERR_INVALID_ARG;
+    Lock lock(kernel_lock);
+    *baudrate = uarts[port].baud ? uarts[port].baud : 115200;
+    return ESP_OK;
+}
+
+int uart_write_bytes(uart_port_t port, const void* data, size_t length) {
+    if (!valid_uart(port)) return -1;
+
+    Lock lock(kernel_lock);
+    UartState& state = uarts[port];
+    if (!state.installed) return -1;
+
+    int64_t now_us = esp_timer_get_time();
+    int64_t start_us = state.tx_busy_until_us > now_us ? state.tx_busy_until_us : now_us;
+    state.tx_busy_until_us = start_us + (int64_t)(length * 10 * 1000000ULL / state.baud);
+
+    const uint8_t* bytes = (const uint8_t*)data;
+    if (state.peer >= 0) {
+        receive(uarts[state.peer], bytes, length);
+    } else if (state.tx.size() < UART_TX_CAPTURE_MAX) {
+        state.tx.insert(state.tx.end(), bytes, bytes + length);
+    }
+    return (int)length;
+}
+
+// Returns once `length` bytes arrived or the timeout passed, with what
+// was read
+int uart_read_bytes(uart_port_t port, void* data, uint32_t length, TickType_t ticks) {
+    if (!valid_uart(port)) return -1;
+
+    Lock lock(kernel_lock);
+    UartState& state = uarts[port];
+    if (!state.installed) return -1;
+
+    kernel_wait(lock, ticks, [&state, length]() {
+        return !state.installed || state.rx.size() >= length;
+    });
+    return (int)consume(state, (uint8_t*)data, length);
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t port, size_t* size) {
+    if (!valid_uart(port) || !size) return ESP_ERR_INVALID_ARG;
+    Lock lock(kernel_lock);
+    *size = uarts[port].rx.size();
+    return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t port) {
+    if (!valid_uart(port)) return ESP_ERR_INVALID_ARG;
+    Lock lock(kernel_lock);
+    UartState& state = uarts[port];
+    state.rx_consumed += state.rx.size();
+    state.rx.clear();
+    state.pattern_positions.clear();
+    state.pattern_run = 0;
+    return ESP_OK;
+}
+
+esp_err_t uart_flush(uart_port_t port) {
+    return uart_flush_input(port);
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t port, TickType_t ticks) {
+    if (!valid_uart(port)) return ESP_ERR_INVALID_ARG;
+
+    int64_t busy_until_us;
+    {
+        Lock lock(kernel_lock);
+        busy_until_us = uarts[port].tx_busy_until_us;
+    }
+
+    int64_t remaining_us = busy_until_us - esp_timer_get_time();
+    if (remaining_us <= 0) return ESP_OK;
+    if ((uint64_t)remaining_us > (uint64_t)ticks * (1000000 / configTICK_RATE_HZ)) {
+        if (ticks) vTaskDelay(ticks);
+        return ESP_ERR_TIMEOUT;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(remaining_us));
+    return ESP_OK;
+}
+
+esp_err_t uart_enable_pattern_det_baud_intr(uart_port_t port, char pattern_chr,
+                                            uint8_t chr_num, int chr_tout,
+                                            int post_idle, int pre_idle) {
+    (void)chr_tout; (void)post_idle; (void)pre_idle;
+    if (!valid_uart(port) || chr_num == 0) return ESP_ERR_INVALID_ARG;
+
+    Lock lock(kernel_lock);
+    UartState& state = uarts[port];
+    state.pattern_enabled = true;
+    state.pattern_char = pattern_chr;
+    state.pattern_count = chr_num;
+    state.pattern_run = 0;
+    return ESP_OK;
+}
+
+esp_err_t uart_disable_pattern_det_intr(uart_port_t port) {
+    if (!valid_uart(port)) return ESP_ERR_INVALID_ARG;
+    Lock lock(kernel_lock);
+    uarts[port].pattern_enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t uart_pattern_queue_reset(uart_port_t port, int queue_length) {
+    if (!valid_uart(port) || queue_length <= 0) return ESP_ERR_INVALID_ARG;
+    Lock lock(kernel_lock);
+    uarts[port].pattern_queue_length = (size_t)queue_length;
+    uarts[port].pattern_positions.clear();
+    return ESP_OK;
+}
+
+// Position relative to the next unread byte, -1 when none is queued
+int uart_pattern_pop_pos(uart_port_t port) {
+    if (!valid_uart(port)) return -1;
+    Lock lock(kernel_lock);
+    UartState& state = uarts[port];
+    if (state.pattern_positions.empty()) return -1;
+    uint64_t position = state.pattern_positions.front();
+    state.pattern_positions.pop_front();
+    return position >= state.rx_consumed ? (int)(position - state.rx_consumed) : -1;
+}
+
+int uart_pattern_get_pos(uart_port_t port) {
+    if (!valid_uart(port)) return -1;
+    Lock lock(kernel_lock);
+    UartState& state = uarts[port];
+    if (state.pattern_positions.empty()) return -1;
+    uint64_t position = state.pattern_positions.front();
+    return position >= state.rx_consumed ? (int)(position - state.rx_consumed) : -1;
+}
+
+void host_uart_connect(uart_port_t a, uart_port_t b) {
+    if (!valid_uart(a) || !valid_uart(b)) return;
+    Lock lock(kernel_lock);
+    uarts[a].peer = b;
+    uarts[b].peer = a;
+}
+
+void host_uart_disconnect(uart_port_t port) {
+    if (!valid_uart(port)) return;
+    Lock lock(kernel_lock);
+    int peer = uarts[port].peer;
+    if (peer >= 0) uarts[peer].peer = -1;
+    uarts[port].peer = -1;
+}
+
+void host_uart_inject(uart_port_t port, const void* data, size_t length) {
+    if (!valid_uart(port)) return;
+    Lock lock(kernel_lock);
+    receive(uarts[port], (const uint8_t*)data, length);
+}
+
+size_t host_uart_take_tx(uart_port_t port, void* out, size_t max_length) {
+    if (!valid_uart(port)) return 0;
+    Lock lock(kernel_lock);
+    std::vector<uint8_t>& tx = uarts[port].tx;
+    size_t count = max_length < tx.size() ? max_length : tx.size();
+    memcpy(out, tx.data(), count);
+    tx.erase(tx.begin(), tx.begin() + count);
+    return count;
+}
+
+}  // extern "C"
+
+// ==================== I2C ====================
+namespace {
+
+struct I2CDevice {
+    uint8_t  address;
+    uint8_t* registers;
+    size_t   size;
+    size_t   pointer;       // Register pointer, kept between transactions
+};
+
+struct I2COp {
+    enum Type { START, STOP, WRITE, READ } type;
+    std::vector<uint8_t> bytes;     // WRITE
+    uint8_t* out;                   // READ
+    size_t length;
+};
+
+struct I2CCommand {
+    std::vector<I2COp> ops;
+};
+
+struct I2CPort {
+    bool                   installed;
+    i2c_mode_t             mode;
+    std::vector<I2CDevice> devices;
+    std::deque<uint8_t>    slave_rx;
+    std::deque<uint8_t>    slave_tx;
+};
+
+I2CPort i2c_ports[I2C_NUM_MAX];
+
+bool valid_i2c(i2c_port_t port) {
+    return port >= 0 && port < I2C_NUM_MAX;
+}
+
+esp_err_t add_op(i2c_cmd_handle_t cmd, I2COp op) {
+    if (!cmd) return ESP_ERR_INVALID_ARG;
+    ((I2CCommand*)cmd)->ops.push_back(std::move(op));
+    return ESP_OK;
+}
+
+}  // namespace
+
+extern "C" {
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t* config) {
+    if (!valid_i2c(port) || !config) return ESP_ERR_INVALID_ARG;
+    i2c_ports[port].mode = config->mode;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t slave_rx_buf_len,
+                             size_t slave_tx_buf_len, int flags) {
+    (void)slave_rx_buf_len; (void)slave_tx_buf_len; (void)flags;
+    if (!valid_i2c(port)) return ESP_ERR_INVALID_ARG;
+    Lock lock(kernel_lock);
+    if (i2c_ports[port].installed) return ESP_FAIL;
+    i2c_ports[port].installed = true;
+    i2c_ports[port].mode = mode;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t port) {
+    if (!valid_i2c(port)) return ESP_ERR_INVALID_ARG;
+    Lock lock(kernel_lock);
+    i2c_ports[port].installed = false;
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void) {
+    return new I2CCommand();
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd) {
+    delete (I2CCommand*)cmd;
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd) {
+    return add_op(cmd, { I2COp::START, {}, nullptr, 0 });
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd) {
+    return add_op(cmd, { I2COp::STOP, {}, nullptr, 0 });
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en) {
+    (void)ack_en;
+    return add_op(cmd, { I2COp::WRITE, { data }, nullptr, 1 });
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t* data, size_t length, bool ack_en) {
+    (void)ack_en;
+    return add_op(cmd, { I2COp::WRITE, std::vector<uint8_t>(data, data + length), nullptr, length });
+}
+
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd, uint8_t* data, i2c_ack_type_t ack) {
+    (void)ack;
+    return add_op(cmd, { I2COp::READ, {}, data, 1 });
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t* data, size_t length, i2c_ack_type_t ack) {
+    (void)ack;
+    return add_op(cmd, { I2COp::READ, {}, data, length });
+}
+
+// The first byte after START is the address; a missing device NAKs it
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks) {
+    (void)ticks;
+    if (!valid_i2c(port) || !cmd) return ESP_ERR_INVALID_ARG;
+
+    Lock lock(kernel_lock);
+    I2CPort& bus = i2c_ports[port];
+    if (!bus.installed) return ESP_ERR_INVALID_STATE;
+
+    I2CDevice* device = nullptr;
+    bool expect_address = false;
+    bool pointer_set = false;
+
+    for (const I2COp& op : ((I2CCommand*)cmd)->ops) {
+        switch (op.type) {
+            case I2COp::START:
+                expect_address = true;
+                break;
+
+            case I2COp::STOP:
+                device = nullptr;
+                pointer_set = false;
+                break;
+
+            case I2COp::WRITE:
+                for (size_t i = 0; i < op.bytes.size(); i++) {
+                    uint8_t byte = op.bytes[i];
+                    if (expect_address) {
+                        expect_address = false;
+                        device = nullptr;
+                        for (I2CDevice& d : bus.devices) {
+                            if (d.address == (byte >> 1)) device = &d;
+                        }
+                        if (!device) return ESP_FAIL;
+                        if ((byte & 1) == I2C_MASTER_WRITE) pointer_set = false;
+                        continue;
+                    }
+                    if (!device) return ESP_FAIL;
+                    if (!pointer_set) {
+                        device->pointer = byte;
+                        pointer_set = true;
+                    } else if (device->pointer < device->size) {
+                        device->registers[device->pointer++] = byte;
+                    }
+                }
+                break;
+
+            case I2COp::READ:
+                if (!device) return ESP_FAIL;
+                for (size_t i = 0; i < op.length; i++) {
+                    op.out[i] = device->pointer < device->size
+                             ? device->registers[device->pointer++] : 0xFF;
+                }
+                break;
+        }
+    }
+    return ESP_OK;
+}
+
+int i2c_slave_read_buffer(i2c_port_t port, uint8_t* data, size_t max_length, TickType_t ticks) {
+    if (!valid_i2c(port)) return -1;
+
+    Lock lock(kernel_lock);
+    I2CPort& bus = i2c_ports[port];
+    kernel_wait(lock, ticks, [&bus]() { return !bus.slave_rx.empty(); });
+
+    size_t count = 0;
+    while (count < max_length && !bus.slave_rx.empty()) {
+        data[count++] = bus.slave_rx.front();
+        bus.slave_rx.pop_front();
+    }
+    return (int)count;
+}
+
+int i2c_slave_write_buffer(i2c_port_t port, const uint8_t* data, int length, TickType_t ticks) {
+    (void)ticks;
+    if (!valid_i2c(port) || length < 0) return -1;
+    Lock lock(kernel_lock);
+    i2c_ports[port].slave_tx.insert(i2c_ports[port].slave_tx.end(), data, data + length);
+    return length;
+}
+
+void host_i2c_add_device(i2c_port_t port, uint8_t address, uint8_t* registers, size_t size) {
+    if (!valid_i2c(port)) return;
+    Lock lock(kernel_lock);
+    i2c_ports[port].devices.push_back({ address, registers, size, 0 });
+}
+
+void host_i2c_remove_devices(i2c_port_t port) {
+    if (!valid_i2c(port)) return;
+    Lock lock(kernel_lock);
+    i2c_ports[port].devices.clear();
+}
+
+void host_i2c_slave_inject(i2c_port_t port, const uint8_t* data, size_t length) {
+    if (!valid_i2c(port)) return;
+    Lock lock(kernel_lock);
+    i2c_ports[port].slave_rx.insert(i2c_ports[port].slave_rx.end(), data, data + length);
+    kernel_changed.notify_all();
+}
+
+size_t host_i2c_slave_take(i2c_port_t port, uint8_t* out, size_t max_length) {
+    if (!valid_i2c(port)) return 0;
+    Lock lock(kernel_lock);
+    std::deque<uint8_t>& tx = i2c_ports[port].slave_tx;
+    size_t count = 0;
+    while (count < max_length && !tx.empty()) {
+        out[count++] = tx.front();
+        tx.pop_front();
+    }
+    return count;
+}
+
+}  // extern "C"
+
+// ==================== LEDC AND ADC ====================
+namespace {
+
+inline constexpr int LEDC_CHANNELS = 16;   // The library indexes both speed modes' worth
+inline constexpr int LEDC_TIMERS = 8;
+
+uint32_t ledc_duty[LEDC_CHANNELS];
+uint32_t ledc_pending[LEDC_CHANNELS];
+bool     ledc_active[LEDC_CHANNELS];
+uint32_t ledc_freq[LEDC_TIMERS];
+int      adc_raw[ADC1_CHANNEL_MAX];
+
+bool valid_channel(ledc_channel_t channel) {
+    return channel >= 0 && channel < LEDC_CHANNELS;
+}
+
+bool valid_timer(ledc_timer_t timer) {
+    return timer >= 0 && timer < LEDC_TIMERS;
+}
+
+}  // namespace
+
+extern "C" {
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* config) {
+    if (!config || !valid_timer(config->timer_num)) return ESP_ERR_INVALID_ARG;
+    ledc_freq[config->timer_num] = config->freq_hz;
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* config) {
+    if (!config || !valid_channel(config->channel)) return ESP_ERR_INVALID_ARG;
+    ledc_duty[config->channel] = config->duty;
+    ledc_pending[config->channel] = config->duty;
+    ledc_active[config->channel] = true;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int flags) {
+    (void)flags;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty) {
+    (void)mode;
+    if (!valid_channel(channel)) return ESP_ERR_INVALID_ARG;
+    ledc_pending[channel] = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel) {
+    (void)mode;
+    if (!valid_channel(channel)) return ESP_ERR_INVALID_ARG;
+    ledc_duty[channel] = ledc_pending[channel];
+    ledc_active[channel] = true;
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t mode, ledc_channel_t channel) {
+    (void)mode;
+    return valid_channel(channel) ? ledc_duty[channel] : 0;
+}
+
+esp_err_t ledc_set_freq(ledc_mode_t mode, ledc_timer_t timer, uint32_t freq_hz) {
+    (void)mode;
+    if (!valid_timer(timer)) return ESP_ERR_INVALID_ARG;
+    ledc_freq[timer] = freq_hz;
+    return ESP_OK;
+}
+
+uint32_t ledc_get_freq(ledc_mode_t mode, ledc_timer_t timer) {
+    (void)mode;
+    return valid_timer(timer) ? ledc_freq[timer] : 0;
+}
+
+// Fades complete at once
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel,
+                                  uint32_t target_duty, int max_fade_time_ms) {
+    (void)max_fade_time_ms;
+    return ledc_set_duty(mode, channel, target_duty);
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel, ledc_fade_mode_t wait) {
+    (void)wait;
+    return ledc_update_duty(mode, channel);
+}
+
+esp_err_t ledc_stop(ledc_mode_t mode, ledc_channel_t channel, uint32_t idle_level) {
+    (void)mode;
+    (void)idle_level;
+    if (!valid_channel(channel)) return ESP_ERR_INVALID_ARG;
+    ledc_active[channel] = false;
+    return ESP_OK;
+}
+
+uint32_t host_ledc_get_freq(ledc_timer_t timer) {
+    return ledc_get_freq(LEDC_LOW_SPEED_MODE, timer);
+}
+
+bool host_ledc_running(ledc_channel_t channel) {
+    return valid_channel(channel) && ledc_active[channel];
+}
+
+esp_err_t adc1_config_width(adc_bits_width_t width) {
+    (void)width;
+    return ESP_OK;
+}
+
+esp_err_t adc1_config_channel_atten(adc1_channel_t channel, adc_atten_t atten) {
+    (void)atten;
+    return channel >= 0 && channel < ADC1_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+int adc1_get_raw(adc1_channel_t channel) {
+    return channel >= 0 && channel < ADC1_CHANNEL_MAX ? adc_raw[channel] : -1;
+}
+
+void host_adc_set(adc1_channel_t channel, int raw) {
+    if (channel >= 0 && channel < ADC1_CHANNEL_MAX) adc_raw[channel] = raw;
+}
+
+}  // extern "C"
+
+// ==================== ENTRY ====================
+// app_main() runs as a task, like on the chip. The process ends when it
+// returns; other tasks are not unwound, so static destructors are
+// skipped rather than run under them.
+namespace {
+
+void main_task(void* param) {
+    (void)param;
+    app_main();
+}
+
+}  // namespace
+
+int main() {
+    for (UartState& state : uarts) state.peer = -1;
+
+    // lwIP has no SIGPIPE; a send to a closed peer just fails
+    signal(SIGPIPE, SIG_IGN);
+
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreate(main_task, "main", 8192, nullptr, 1, &handle) != pdPASS) return 1;
+
+    {
+        Lock lock(kernel_lock);
+        kernel_changed.wait(lock, [handle]() { return handle->finished; });
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    _Exit(exit_code);
+}
@@ -0,0 +1,66 @@
+#ifndef HOST_IDF_H
+#define HOST_IDF_H
+
+// Test-side control of the simulated chip in host_idf.cpp: drive input
+// pins, feed and capture UART lines, attach I2C register devices and move
+// the clock. Firmware code never includes this.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "driver/i2c.h"
+#include "driver/ledc.h"
+#include "driver/adc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Clock: esp_timer_get_time() is the host's monotonic clock plus an
+// offset, so a test can jump close to a wrap point. Delays and timeouts
+// keep running in real time.
+void host_clock_advance_us(int64_t us);
+void host_clock_set_us(int64_t us);
+
+// GPIO: input levels feed GPIO.in/in1 and fire enabled edge interrupts
+// on the calling thread, like an ISR would interrupt it
+void host_gpio_set_input(uint8_t pin, bool level);
+bool host_gpio_get_output(uint8_t pin);
+bool host_gpio_output_enabled(uint8_t pin);
+int host_gpio_get_pull(uint8_t pin);        // 1 up, -1 down, 0 none
+
+// UART: bytes written to a connected port arrive on its peer (null-modem);
+// otherwise they are kept until taken. Transmission takes 10 bit times
+// per byte at the configured baud rate, as seen by uart_wait_tx_done().
+void host_uart_connect(uart_port_t a, uart_port_t b);
+void host_uart_disconnect(uart_port_t port);
+void host_uart_inject(uart_port_t port, const void* data, size_t length);
+size_t host_uart_take_tx(uart_port_t port, void* out, size_t max_length);
+
+// I2C: a device is a register file; the first byte of a write sets the
+// register pointer, following bytes are stored and reads auto-increment
+void host_i2c_add_device(i2c_port_t port, uint8_t address, uint8_t* registers, size_t size);
+void host_i2c_remove_devices(i2c_port_t port);
+void host_i2c_slave_inject(i2c_port_t port, const uint8_t* data, size_t length);
+size_t host_i2c_slave_take(i2c_port_t port, uint8_t* out, size_t max_length);
+
+// LEDC and ADC state
+uint32_t host_ledc_get_freq(ledc_timer_t timer);
+bool host_ledc_running(ledc_channel_t channel);
+void host_adc_set(adc1_channel_t channel, int raw);
+
+// Added to the task's run time counter, to test counter wrap handling
+void host_task_add_runtime(TaskHandle_t task, uint32_t offset_us);
+
+// Exit status of the test binary, returned once app_main() finishes
+void host_set_exit_code(int code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef HOST_SOC_GPIO_STRUCT_H
+#define HOST_SOC_GPIO_STRUCT_H
+
+#include <stdint.h>
+
+// Simulated GPIO register block. The W1TS/W1TC members are write-only
+// views: storing a mask sets or clears those bits of the register they
+// control, like the hardware does.
+
+struct host_gpio_w1ts {
+    volatile uint32_t* reg;
+    void operator=(uint32_t mask) { *reg = *reg | mask; }
+};
+
+struct host_gpio_w1tc {
+    volatile uint32_t* reg;
+    void operator=(uint32_t mask) { *reg = *reg & ~mask; }
+};
+
+typedef struct {
+    volatile uint32_t val;
+} host_gpio_reg_t;
+
+typedef struct {
+    host_gpio_w1ts val;
+} host_gpio_reg_w1ts_t;
+
+typedef struct {
+    host_gpio_w1tc val;
+} host_gpio_reg_w1tc_t;
+
+struct gpio_dev_t {
+    volatile uint32_t    out;
+    host_gpio_w1ts       out_w1ts;
+    host_gpio_w1tc       out_w1tc;
+    host_gpio_reg_t      out1;
+    host_gpio_reg_w1ts_t out1_w1ts;
+    host_gpio_reg_w1tc_t out1_w1tc;
+    volatile uint32_t    enable;
+    host_gpio_w1ts       enable_w1ts;
+    host_gpio_w1tc       enable_w1tc;
+    host_gpio_reg_t      enable1;
+    host_gpio_reg_w1ts_t enable1_w1ts;
+    host_gpio_reg_w1tc_t enable1_w1tc;
+    volatile uint32_t    in;
+    host_gpio_reg_t      in1;
+
+    gpio_dev_t()
+        : out(0), out_w1ts{&out}, out_w1tc{&out},
+          out1{0}, out1_w1ts{{&out1.val}}, out1_w1tc{{&out1.val}},
+          enable(0), enable_w1ts{&enable}, enable_w1tc{&enable},
+          enable1{0}, enable1_w1ts{{&enable1.val}}, enable1_w1tc{{&enable1.val}},
+          in(0), in1{0} {}
+
+    gpio_dev_t(const gpio_dev_t&) = delete;
+    gpio_dev_t& operator=(const gpio_dev_t&) = delete;
+};
+
+extern gpio_dev_t GPIO;
+
+#endif
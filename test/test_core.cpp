@@ -0,0 +1,230 @@
+// Smoke test of the host build: pins, PWM, ADC, UART, I2C and tasks
+// running against the simulated chip in idf/.
+
+#include "ArduLiteESP.h"
+#include "ArduLiteESP_I2C.h"
+#include "host_test.h"
+
+#include <atomic>
+#include <ctime>
+#include <type_traits>
+
+// Arduino's TimeLib declares a global now(); the library must not clash
+time_t now() {
+    return 0;
+}
+
+TEST(digital_out_drives_register) {
+    Digital pin(5, OUT);
+    CHECK(host_gpio_output_enabled(5));
+
+    pin.on();
+    CHECK(host_gpio_get_output(5));
+    pin.toggle();
+    CHECK(!host_gpio_get_output(5));
+    pin.write(true);
+    CHECK(host_gpio_get_output(5));
+    pin.off();
+    CHECK(!host_gpio_get_output(5));
+}
+
+TEST(digital_in_reads_level_and_pull) {
+    Digital pin(34, IN_PULLUP);
+    CHECK(!host_gpio_output_enabled(34));
+    CHECK_EQ(host_gpio_get_pull(34), 1);
+
+    host_gpio_set_input(34, true);
+    CHECK(pin.read());
+    host_gpio_set_input(34, false);
+    CHECK(!pin.read());
+}
+
+TEST(digital_port_spans_both_banks) {
+    DigitalPort port{30, 31, 32, 33};
+    port.write(0x5);
+    CHECK(host_gpio_get_output(30));
+    CHECK(!host_gpio_get_output(31));
+    CHECK(host_gpio_get_output(32));
+    CHECK(!host_gpio_get_output(33));
+
+    port.set(0x2);
+    port.clear(0x1);
+    CHECK(!host_gpio_get_output(30));
+    CHECK(host_gpio_get_output(31));
+    port.write(0);
+}
+
+TEST(digital_port_drops_extra_pins) {
+    DigitalPort wide{4, 5, 12, 13, 14, 15, 16, 17, 18};
+    CHECK_EQ(wide.getPinCount(), DIGITAL_PORT_MAX_PINS);
+    wide.write(0x1FF);
+    CHECK(host_gpio_get_output(17));
+    CHECK(!host_gpio_get_output(18));
+    wide.write(0);
+
+    static const uint8_t pins[] = {30, 31};
+    DigitalPort pair(pins);
+    CHECK_EQ(pair.getPinCount(), 2);
+}
+
+TEST(pulse_capture_keeps_its_handler) {
+    host_gpio_set_input(26, false);
+    PulseCapture capture(26);
+    CHECK(capture.begin());
+
+    // Never started: must not remove the handler installed above
+    { PulseCapture unused(26); }
+
+    host_gpio_set_input(26, true);
+    host_clock_advance_us(300);
+    host_gpio_set_input(26, false);
+    uint32_t width = capture.read();
+    CHECK(width >= 300 && width < 5000);
+
+    capture.end();
+    host_gpio_set_input(26, true);
+    CHECK_EQ(capture.available(), 0u);
+}
+
+TEST(pwm_and_analog) {
+    PWM pwm(18, 1000, 10);
+    pwm.write(2000);
+    CHECK_EQ(pwm.read(), 1023);
+    pwm.writePercent(50.0f);
+    CHECK_EQ(pwm.read(), 511);
+
+    Analog input(34);
+    host_adc_set(ADC1_CHANNEL_6, 2048);
+    CHECK_EQ(input.read(), 2048);
+}
+
+TEST(timer_follows_clock) {
+    Timer timer;
+    timer.start();
+    host_clock_advance_us(250000);
+    CHECK(timer.elapsed() >= 250);
+    CHECK(timer.timeout(200));
+    CHECK(!timer.timeout(200));
+}
+
+TEST(instant_snapshot_is_shared) {
+    Instant t = Instant::now();
+    Timer timer;
+    timer.start(t);
+    host_clock_advance_us(250000);
+    CHECK_EQ(timer.elapsed(t), 0u);
+    CHECK(timer.elapsed() >= 250);
+
+    Deadline deadline(100000, t);
+    CHECK(!deadline.expired(t));
+    CHECK(deadline.expired());
+    CHECK_EQ(now(), 0);
+}
+
+TEST(uart_lines_cross_a_null_modem) {
+    static char received[64];
+    static std::atomic<int> lines(0);
+
+    host_uart_connect(UART_NUM_1, UART_NUM_2);
+    uart2.begin(115200, [](const char* line) {
+        strncpy(received, line, sizeof(received) - 1);
+        lines++;
+    });
+    uart1.begin(115200);
+
+    uart1.sendLine("hello host");
+    for (int i = 0; i < 100 && lines.load() == 0; i++) wait(1);
+
+    CHECK_EQ(lines.load(), 1);
+    CHECK_STR(received, "hello host");
+}
+
+TEST(i2c_register_device) {
+    uint8_t registers[16] = {};
+    registers[0x0F] = 0x68;
+    host_i2c_add_device(I2C_NUM_0, 0x68, registers, sizeof(registers));
+
+    I2C device(I2C_NUM_0, 0x68);
+    CHECK(device.begin());
+
+    uint8_t value = 0;
+    CHECK(device.readByte(0x0F, &value));
+    CHECK_EQ(value, 0x68);
+
+    CHECK(device.writeByte(0x02, 0xAB));
+    CHECK_EQ(registers[0x02], 0xAB);
+
+    I2C missing(I2C_NUM_0, 0x10);
+    CHECK(!missing.writeByte(0x00, 1));
+}
+
+TEST(task_notification) {
+    static StaticTask<2048> worker;
+    static std::atomic<uint32_t> taken(0);
+
+    worker.start([]() {
+        forever() {
+            taken += StaticTask<2048>::waitNotify();
+        }
+    }, "worker");
+
+    worker.notify();
+    worker.notify();
+    for (int i = 0; i < 100 && taken.load() < 2; i++) wait(1);
+    CHECK_EQ(taken.load(), 2);
+
+    worker.stop();
+    CHECK(!worker.running());
+}
+
+TEST(periodic_task_sub_tick_period) {
+    static PeriodicTask<> control;
+    static std::atomic<uint32_t> runs(0);
+
+    // 1.5 ms is not a whole number of ticks, so the esp_timer releases it
+    CHECK(control.start([]() { runs++; }, "ctrl", 1500));
+    CHECK(!control.usesTicks());
+    CHECK(control.getHandle() != nullptr);
+    for (int i = 0; i < 100 && runs.load() < 3; i++) wait(1);
+    CHECK(runs.load() >= 3);
+
+    PeriodicStats stats;
+    control.getStats(stats);
+    CHECK(stats.activations >= 3);
+    CHECK(stats.jitter_min_us >= 0);
+
+    control.stop();
+    CHECK(!control.running());
+}
+
+static_assert(!std::is_copy_constructible<StaticTask<2048>>::value, "StaticTask copyable");
+static_assert(!std::is_copy_assignable<StaticTask<2048>>::value, "StaticTask assignable");
+static_assert(!std::is_copy_constructible<PeriodicTask<>>::value, "PeriodicTask copyable");
+static_assert(!std::is_copy_assignable<PeriodicTask<>>::value, "PeriodicTask assignable");
+static_assert(!std::is_copy_constructible<PulseCapture>::value, "PulseCapture copyable");
+static_assert(!std::is_copy_assignable<PulseCapture>::value, "PulseCapture assignable");
+
+TEST(task_runtime_survives_counter_wrap) {
+    static StaticTask<2048> idler;
+    idler.start([]() {
+        forever() {
+            wait(1);
+        }
+    }, "idler");
+
+    uint64_t before = idler.runtimeUs();
+    host_task_add_runtime(idler.getHandle(), 0xF0000000UL);
+    CHECK(idler.runtimeUs() >= before + 0xF0000000ULL);
+
+    // The 32-bit counter wraps here; the 64-bit total keeps counting
+    host_task_add_runtime(idler.getHandle(), 0x20000000UL);
+    uint64_t after = idler.runtimeUs();
+    CHECK(after >= before + 0x110000000ULL);
+    CHECK(after < before + 0x110000000ULL + 1000000);
+
+    idler.stop();
+}
+
+void main() {
+    host_run_tests();
+}
@@ -0,0 +1,60 @@
+// CRC-16/MODBUS: table, slicing-by-4 and incremental forms against the
+// bitwise reference.
+
+#include "ArduLiteESP_MODBUS.h"
+#include "host_test.h"
+
+#include <stdlib.h>
+
+TEST(check_value) {
+    const uint8_t text[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    CHECK_EQ(ModbusCRC16::computeBitwise(text, sizeof(text)), 0x4B37);
+    CHECK_EQ(ModbusCRC16::compute(text, sizeof(text)), 0x4B37);
+    CHECK_EQ(ModbusCRC16::computeSlice4(text, sizeof(text)), 0x4B37);
+}
+
+TEST(read_holding_request) {
+    // 01 03 0000 000A, CRC sent low byte first: C5 CD
+    uint8_t frame[8] = { 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A };
+    uint16_t crc = ModbusCRC16::compute(frame, 6);
+    CHECK_EQ(crc, 0xCDC5);
+
+    frame[6] = crc & 0xFF;
+    frame[7] = crc >> 8;
+    CHECK_EQ(ModbusCRC16::compute(frame, 8), 0);       // Zero residue
+}
+
+TEST(all_forms_agree_on_every_length) {
+    uint8_t data[300];
+    srand(1);
+    for (uint8_t& b : data) b = (uint8_t)rand();
+
+    for (uint16_t length = 0; length <= sizeof(data); length++) {
+        uint16_t reference = ModbusCRC16::computeBitwise(data, length);
+        CHECK_EQ(ModbusCRC16::compute(data, length), reference);
+        CHECK_EQ(ModbusCRC16::computeSlice4(data, length), reference);
+
+        ModbusCRC16 bytewise;
+        for (uint16_t i = 0; i < length; i++) bytewise.update(data[i]);
+        CHECK_EQ(bytewise.value(), reference);
+    }
+}
+
+TEST(incremental_chunks_and_reset) {
+    uint8_t data[256];
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(i * 7 + 3);
+    uint16_t reference = ModbusCRC16::compute(data, sizeof(data));
+
+    ModbusCRC16 crc;
+    crc.update(data, 13);
+    crc.update(&data[13], 100);
+    crc.update(&data[113], sizeof(data) - 113);
+    CHECK_EQ(crc.value(), reference);
+
+    crc.reset();
+    CHECK_EQ(crc.value(), ModbusCRC16::INIT);
+}
+
+void main() {
+    host_run_tests();
+}
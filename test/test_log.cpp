@@ -0,0 +1,184 @@
+// Deferred binary log: records go through the ring and the drain task,
+// come out of the UART as COBS packets and are decoded here the way
+// extras/log_decode.py does it.
+
+#define DEBUG
+#define DEBUG_DEFERRED
+#include "ArduLiteESP_Log.h"
+#include "host_test.h"
+
+#include <vector>
+
+struct Entry {
+    uint32_t id;
+    uint32_t time_us;
+    uint8_t level;
+    uint8_t param;
+    uint8_t argc;
+    uint32_t args[LOG_MAX_ARGS];
+};
+
+static std::vector<Entry> entries;
+static PacketDecoder<64> decoder;
+
+static void parse(uint8_t type, const uint8_t* data, size_t length) {
+    CHECK_EQ(type, LOG_PACKET_TYPE);
+    CHECK(length >= LOG_RECORD_HEADER_SIZE);
+    Entry entry = {};
+    memcpy(&entry.id, &data[0], 4);
+    memcpy(&entry.time_us, &data[4], 4);
+    entry.level = data[8];
+    entry.param = data[9];
+    entry.argc = data[10];
+    CHECK_EQ(length, LOG_RECORD_HEADER_SIZE + entry.argc * 4);
+    memcpy(entry.args, &data[LOG_RECORD_HEADER_SIZE], entry.argc * 4);
+    entries.push_back(entry);
+}
+
+static void start() {
+    static bool started = false;
+    if (started) return;
+    started = true;
+
+    uart.begin(921600);
+    decoder.setHandler(parse);
+    CHECK(logger.begin(uart));
+}
+
+// Collect drained records until `count` have arrived or 500 ms pass
+static size_t receive(size_t count) {
+    uint8_t chunk[512];
+    for (int i = 0; i < 500 && entries.size() < count; i++) {
+        size_t length;
+        while ((length = host_uart_take_tx(UART_NUM_0, chunk, sizeof(chunk))) > 0) {
+            decoder.feed(chunk, length);
+        }
+        if (entries.size() < count) wait(1);
+    }
+    return entries.size();
+}
+
+static uint32_t word(float value) {
+    uint32_t w;
+    memcpy(&w, &value, 4);
+    return w;
+}
+
+TEST(format_id_and_raw_arguments) {
+    start();
+    entries.clear();
+
+    static const char* const format = "adc=%d t=%f";
+    logger.record(LOG_LEVEL_INFO, format, -5, 21.5f);
+    LOG_W("three %u %u %u", 1u, 2u, 3u);
+
+    CHECK_EQ(receive(2), 2);
+    CHECK_EQ(entries[0].id, (uint32_t)(uintptr_t)format);
+    CHECK_EQ(entries[0].level, LOG_LEVEL_INFO);
+    CHECK_EQ(entries[0].argc, 2);
+    CHECK_EQ((int32_t)entries[0].args[0], -5);
+    CHECK_EQ(entries[0].args[1], word(21.5f));
+    CHECK_EQ(entries[1].level, LOG_LEVEL_WARN);
+    CHECK_EQ(entries[1].argc, 3);
+    CHECK_EQ(entries[1].args[2], 3);
+}
+
+TEST(disabled_levels_compile_out) {
+    start();
+    entries.clear();
+
+    int evaluated = 0;
+    LOG_D("never %d", ++evaluated);  // LOG_LEVEL is INFO
+    LOG_E("kept %d", ++evaluated);
+
+    CHECK_EQ(evaluated, 1);
+    CHECK_EQ(receive(1), 1);
+    CHECK_EQ(entries[0].level, LOG_LEVEL_ERROR);
+}
+
+TEST(debug_values_are_tagged) {
+    start();
+    entries.clear();
+
+    debug(-7);
+    debug(2.5f, 1);
+    debugLine(true);
+    debugLine("hello, log");
+    char name[] = "pump";
+    debug(name);                // char*, not a pointer value
+
+    CHECK_EQ(receive(5), 5);
+    CHECK_EQ(entries[0].id, LOG_TAG_INT);
+    CHECK_EQ((int32_t)entries[0].args[0], -7);
+    CHECK_EQ(entries[1].id, LOG_TAG_FLOAT);
+    CHECK_EQ(entries[1].param, 1);
+    CHECK_EQ(entries[1].args[0], word(2.5f));
+    CHECK_EQ(entries[2].id, LOG_TAG_BOOL);
+    CHECK_EQ(entries[2].param, LOG_PARAM_NEWLINE);
+    CHECK_EQ(entries[3].id, LOG_TAG_STRING);
+    CHECK_EQ(entries[3].argc, 3);
+    CHECK(memcmp(entries[3].args, "hello, log", 10) == 0);
+    CHECK_EQ(entries[4].id, LOG_TAG_STRING);
+    CHECK(memcmp(entries[4].args, "pump", 4) == 0);
+}
+
+TEST(overflow_is_counted_and_reported) {
+    start();
+    entries.clear();
+
+    const uint32_t total = 1000;
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < total; i++) {
+        if (logger.record(LOG_LEVEL_INFO, "burst %u", i)) accepted++;
+    }
+    CHECK(accepted < total);
+
+    size_t expected = accepted + 1;  // Plus one LOG_TAG_DROPPED record
+    CHECK_EQ(receive(expected), expected);
+
+    uint32_t lost = 0;
+    uint32_t logged = 0;
+    for (const Entry& entry : entries) {
+        if (entry.id == LOG_TAG_DROPPED) lost += entry.args[0];
+        else logged++;
+    }
+    CHECK_EQ(logged, accepted);
+    CHECK_EQ(lost, total - accepted);
+}
+
+TEST(producers_on_several_tasks) {
+    start();
+    entries.clear();
+
+    static std::atomic<uint32_t> accepted(0);
+    static std::atomic<int> finished(0);
+    const int producers = 4;
+    uint32_t dropped_before = logger.getDroppedCount();
+    for (int p = 0; p < producers; p++) {
+        xTaskCreate([](void*) {
+            for (uint32_t i = 0; i < 200; i++) {
+                if (logger.record(LOG_LEVEL_INFO, "task %u", i)) accepted++;
+                if (i % 16 == 15) vTaskDelay(1);
+            }
+            finished++;
+            vTaskDelete(nullptr);
+        }, "producer", 4096, nullptr, 1, nullptr);
+    }
+    for (int i = 0; i < 2000 && finished.load() < producers; i++) wait(1);
+    CHECK_EQ(finished.load(), producers);
+
+    receive(accepted.load());
+    wait(3 * LOG_DRAIN_INTERVAL_MS);
+    receive(accepted.load() + 1);
+
+    uint32_t logged = 0;
+    for (const Entry& entry : entries) {
+        if (entry.id != LOG_TAG_DROPPED) logged++;
+    }
+    CHECK_EQ(logged, accepted.load());
+    CHECK_EQ(accepted.load() + (logger.getDroppedCount() - dropped_before), producers * 200);
+}
+
+void main() {
+    host_run_tests();
+}
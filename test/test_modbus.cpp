@@ -0,0 +1,395 @@
+// Modbus RTU master and slave talking over a simulated null-modem cable
+// (uart1 <-> uart2), plus frame reception edge cases.
+
+#include "ArduLiteESP_MODBUS.h"
+#include "ArduLiteESP_Task.h"
+#include "host_test.h"
+
+#include <time.h>
+
+static ModbusMaster master(&uart1, 200);
+static ModbusSlave slave(&uart2, 7);
+
+// Exposes frame reception for direct tests
+class FrameProbe : public ModbusRTU {
+public:
+    explicit FrameProbe(UART* port) : ModbusRTU(port) {}
+
+    uint16_t receive(uint32_t timeout) {
+        return receiveFrame(timeout);
+    }
+
+    void send(uint8_t* frame, uint16_t length) {
+        sendFrame(frame, length);
+    }
+
+    uint16_t receiveRead(uint32_t timeout) {
+        rx_length = 0;
+        updateTiming();
+        return receiveFrameRead(timeout);
+    }
+};
+
+static void startBus() {
+    static bool started = false;
+    if (started) return;
+    started = true;
+
+    host_uart_connect(UART_NUM_1, UART_NUM_2);
+    uart1.begin(115200);
+    uart2.begin(115200);
+    Task([]() {
+        forever() {
+            slave.process();
+            wait(1);
+        }
+    }, "slave");
+}
+
+TEST(master_reads_and_writes_holding_registers) {
+    startBus();
+    slave.setHoldingRegister(10, 0x1234);
+    slave.setHoldingRegister(11, 0xBEEF);
+
+    uint16_t values[2] = {};
+    CHECK(master.readHoldingRegisters(7, 10, 2, values));
+    CHECK_EQ(values[0], 0x1234);
+    CHECK_EQ(values[1], 0xBEEF);
+
+    CHECK(master.writeSingleRegister(7, 12, 42));
+    CHECK_EQ(slave.getHoldingRegister(12), 42);
+}
+
+TEST(master_reports_exception) {
+    startBus();
+    uint16_t values[2];
+    CHECK(!master.readHoldingRegisters(7, 255, 2, values));
+    CHECK_EQ(master.getLastException(), MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+}
+
+TEST(update_never_blocks_on_rs485_drain_or_t35) {
+    startBus();
+    ModbusMaster async_master(&uart1, 200);
+    CHECK(async_master.enableRS485(4));
+
+    // 100 registers: a ~209 byte frame, ~18 ms on the wire at 115200
+    static uint16_t values[2][100];
+    ModbusRequest requests[2] = {};
+    for (int r = 0; r < 2; r++) {
+        for (int i = 0; i < 100; i++) values[r][i] = r * 1000 + i;
+        requests[r].slave = 7;
+        requests[r].function = MODBUS_FC_WRITE_MULTIPLE_REGISTERS;
+        requests[r].address = 100 * r;
+        requests[r].quantity = 100;
+        requests[r].registers = values[r];
+        CHECK(async_master.submit(requests[r]));
+    }
+
+    int64_t longest_us = 0;
+    uint32_t start = millis();
+    while (async_master.isBusy() && millis() - start < 1000) {
+        int64_t call_us = esp_timer_get_time();
+        async_master.update();
+        call_us = esp_timer_get_time() - call_us;
+        if (call_us > longest_us) longest_us = call_us;
+        wait(1);
+    }
+
+    CHECK(requests[0].ok());
+    CHECK(requests[1].ok());
+    CHECK(longest_us < 5000);
+    CHECK_EQ(slave.getHoldingRegister(199), 1099);
+}
+
+// Runs before anything starts UART_NUM_0
+TEST(receive_without_driver_returns_instead_of_spinning) {
+    UART unused(UART_NUM_0);
+    FrameProbe probe(&unused);
+
+    uint32_t start = millis();
+    CHECK_EQ(probe.receive(500), 0);
+    CHECK(millis() - start < 100);
+}
+
+static int64_t threadCpuUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+TEST(back_to_back_frames_wait_t35_without_spinning) {
+    uart.begin(9600);
+    FrameProbe probe(&uart);
+
+    // 100 bytes at 9600 baud: ~115 ms on the wire, then t3.5 = 4 ms
+    uint8_t frame[100] = {};
+    int64_t start_us = esp_timer_get_time();
+    int64_t cpu_start_us = threadCpuUs();
+    probe.send(frame, sizeof(frame));
+    probe.send(frame, sizeof(frame));
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    int64_t cpu_us = threadCpuUs() - cpu_start_us;
+
+    CHECK(elapsed_us >= 100 * 1146 + 4000);
+    CHECK(cpu_us < elapsed_us / 4);
+
+    uint8_t sent[256];
+    CHECK_EQ(host_uart_take_tx(UART_NUM_0, sent, sizeof(sent)), 2 * sizeof(frame));
+}
+
+TEST(blocking_read_fallback_ends_frame_on_silence) {
+    uart.begin(115200);
+    FrameProbe probe(&uart);
+
+    const uint8_t frame[] = { 0x07, 0x03, 0x00, 0x0A, 0x00, 0x02, 0xE4, 0x6C };
+    host_uart_inject(UART_NUM_0, frame, sizeof(frame));
+
+    uint32_t start = millis();
+    CHECK_EQ(probe.receiveRead(500), sizeof(frame));
+    CHECK(millis() - start < 100);
+
+    start = millis();
+    CHECK_EQ(probe.receiveRead(50), 0);
+    CHECK(millis() - start >= 50);
+}
+
+// Sparse slave: only linked ranges, driven through handlePDU()
+static ModbusSlaveT<0, 0, 0, 0> sparse(nullptr, 1);
+static uint16_t low_registers[4] = { 1, 2, 3, 4 };
+static uint16_t high_registers[2] = { 0xAAAA, 0xBBBB };
+static bool low_coils[8] = { true };
+
+static uint8_t pdu(const uint8_t* request, uint16_t length, uint8_t* response) {
+    uint16_t reply = sparse.handlePDU(request, length, response);
+    CHECK(reply >= 2);
+    return (response[0] & 0x80) ? response[1] : 0;
+}
+
+TEST(ranges_do_not_wrap_past_0xffff) {
+    CHECK(sparse.mapHoldingRegisters(0x0000, 4, low_registers));
+    CHECK(sparse.mapHoldingRegisters(0xFFFE, 2, high_registers));
+    CHECK(sparse.mapCoils(0x0000, 8, low_coils));
+
+    uint8_t response[256];
+    const uint8_t read_end[] = { 0x03, 0xFF, 0xFE, 0x00, 0x02 };
+    CHECK_EQ(pdu(read_end, sizeof(read_end), response), 0);
+    CHECK_EQ(response[3], 0xAA);
+
+    const uint8_t read_wrap[] = { 0x03, 0xFF, 0xFF, 0x00, 0x02 };
+    CHECK_EQ(pdu(read_wrap, sizeof(read_wrap), response), MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+
+    const uint8_t write_wrap[] = { 0x10, 0xFF, 0xFF, 0x00, 0x02, 0x04, 0, 9, 0, 9 };
+    CHECK_EQ(pdu(write_wrap, sizeof(write_wrap), response), MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+    CHECK_EQ(low_registers[0], 1);
+    CHECK_EQ(high_registers[1], 0xBBBB);
+
+    const uint8_t coils_wrap[] = { 0x01, 0xFF, 0xFC, 0x00, 0x08 };
+    CHECK_EQ(pdu(coils_wrap, sizeof(coils_wrap), response), MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+}
+
+TEST(write_multiple_checks_byte_count_and_length) {
+    uint8_t response[256];
+
+    // Byte count says 4 but only 2 data bytes arrived
+    const uint8_t short_registers[] = { 0x10, 0x00, 0x00, 0x00, 0x02, 0x04, 0, 7 };
+    CHECK_EQ(pdu(short_registers, sizeof(short_registers), response), MODBUS_EX_ILLEGAL_DATA_VALUE);
+
+    const uint8_t odd_count[] = { 0x10, 0x00, 0x00, 0x00, 0x02, 0x03, 0, 7, 0 };
+    CHECK_EQ(pdu(odd_count, sizeof(odd_count), response), MODBUS_EX_ILLEGAL_DATA_VALUE);
+    CHECK_EQ(low_registers[0], 1);
+
+    const uint8_t coil_count[] = { 0x0F, 0x00, 0x00, 0x00, 0x08, 0x02, 0xFF, 0xFF };
+    CHECK_EQ(pdu(coil_count, sizeof(coil_count), response), MODBUS_EX_ILLEGAL_DATA_VALUE);
+
+    const uint8_t short_coils[] = { 0x0F, 0x00, 0x00, 0x00, 0x09, 0x02, 0xFF };
+    CHECK_EQ(pdu(short_coils, sizeof(short_coils), response), MODBUS_EX_ILLEGAL_DATA_VALUE);
+    CHECK(!low_coils[1]);
+
+    const uint8_t good[] = { 0x10, 0x00, 0x00, 0x00, 0x02, 0x04, 0, 7, 0, 8 };
+    CHECK_EQ(pdu(good, sizeof(good), response), 0);
+    CHECK_EQ(low_registers[1], 8);
+}
+
+// Scripted slave on uart (UART_NUM_0): the reply is injected by hand, so
+// it can be truncated or carry a wrong echo
+static void injectReply(const uint8_t* pdu, uint16_t length) {
+    uint8_t frame[64];
+    memcpy(frame, pdu, length);
+    uint16_t crc = ModbusCRC16::compute(frame, length);
+    frame[length] = crc & 0xFF;
+    frame[length + 1] = crc >> 8;
+    host_uart_inject(UART_NUM_0, frame, length + 2);
+}
+
+static uint8_t runAsync(ModbusMaster& async_master, ModbusRequest& request,
+                        const uint8_t* reply, uint16_t length) {
+    uint8_t sent[256];
+    CHECK(async_master.submit(request));
+
+    uint32_t start = millis();
+    while (request.status == MODBUS_STATUS_QUEUED && millis() - start < 500) {
+        async_master.update();
+        wait(1);
+    }
+    host_uart_take_tx(UART_NUM_0, sent, sizeof(sent));
+    injectReply(reply, length);
+
+    while (async_master.isBusy() && millis() - start < 500) {
+        async_master.update();
+        wait(1);
+    }
+    return request.status;
+}
+
+TEST(async_writes_check_the_echo) {
+    uart.begin(115200);
+    ModbusMaster async_master(&uart, 100);
+
+    static uint16_t value = 0x1234;
+    ModbusRequest request = {};
+    request.slave = 3;
+    request.function = MODBUS_FC_WRITE_SINGLE_REGISTER;
+    request.address = 0x0010;
+    request.registers = &value;
+
+    const uint8_t good[] = { 0x03, 0x06, 0x00, 0x10, 0x12, 0x34 };
+    CHECK_EQ(runAsync(async_master, request, good, sizeof(good)), MODBUS_STATUS_DONE);
+
+    const uint8_t wrong_value[] = { 0x03, 0x06, 0x00, 0x10, 0x12, 0x35 };
+    CHECK_EQ(runAsync(async_master, request, wrong_value, sizeof(wrong_value)), MODBUS_STATUS_FRAME_ERROR);
+
+    const uint8_t truncated[] = { 0x03, 0x06, 0x00 };
+    CHECK_EQ(runAsync(async_master, request, truncated, sizeof(truncated)), MODBUS_STATUS_FRAME_ERROR);
+
+    static uint16_t values[3] = { 1, 2, 3 };
+    request.function = MODBUS_FC_WRITE_MULTIPLE_REGISTERS;
+    request.quantity = 3;
+    request.registers = values;
+    const uint8_t wrong_quantity[] = { 0x03, 0x10, 0x00, 0x10, 0x00, 0x02 };
+    CHECK_EQ(runAsync(async_master, request, wrong_quantity, sizeof(wrong_quantity)), MODBUS_STATUS_FRAME_ERROR);
+    const uint8_t quantity_ok[] = { 0x03, 0x10, 0x00, 0x10, 0x00, 0x03 };
+    CHECK_EQ(runAsync(async_master, request, quantity_ok, sizeof(quantity_ok)), MODBUS_STATUS_DONE);
+}
+
+// Answers the next frame the master sends on UART_NUM_0 with `scripted`
+static uint8_t scripted[32];
+static volatile uint16_t scripted_length = 0;
+
+static void script(const uint8_t* pdu, uint16_t length) {
+    static bool started = false;
+    if (!started) {
+        started = true;
+        Task([]() {
+            forever() {
+                uint8_t sent[256];
+                uint16_t length = scripted_length;
+                if (length && host_uart_take_tx(UART_NUM_0, sent, sizeof(sent)) > 0) {
+                    // Cleared first: the test may script the next reply as
+                    // soon as this one is injected
+                    scripted_length = 0;
+                    injectReply(scripted, length);
+                }
+                wait(1);
+            }
+        }, "scripted");
+    }
+    memcpy(scripted, pdu, length);
+    scripted_length = length;
+}
+
+TEST(blocking_replies_are_checked_for_length_and_echo) {
+    uart.begin(115200);
+    ModbusMaster checked(&uart, 100);
+
+    uint16_t read_data[2] = { 0xEEEE, 0xEEEE };
+    const uint16_t write_data[1] = { 9 };
+
+    // Byte count 4, but only 2 data bytes arrived
+    const uint8_t truncated[] = { 0x03, 0x17, 0x04, 0x00, 0x01 };
+    script(truncated, sizeof(truncated));
+    CHECK(!checked.readWriteMultipleRegisters(3, 0, 2, read_data, 10, 1, write_data));
+    CHECK_EQ(read_data[0], 0xEEEE);
+
+    const uint8_t other_slave[] = { 0x04, 0x17, 0x04, 0x00, 0x01, 0x00, 0x02 };
+    script(other_slave, sizeof(other_slave));
+    CHECK(!checked.readWriteMultipleRegisters(3, 0, 2, read_data, 10, 1, write_data));
+
+    const uint8_t good[] = { 0x03, 0x17, 0x04, 0x00, 0x01, 0x00, 0x02 };
+    script(good, sizeof(good));
+    CHECK(checked.readWriteMultipleRegisters(3, 0, 2, read_data, 10, 1, write_data));
+    CHECK_EQ(read_data[1], 2);
+
+    uint16_t result = 0;
+    const uint8_t diag_short[] = { 0x03, 0x08, 0x00, 0x0B };
+    script(diag_short, sizeof(diag_short));
+    CHECK(!checked.diagnostics(3, MODBUS_DIAG_BUS_MESSAGE_COUNT, 0, &result));
+
+    const uint8_t diag_other[] = { 0x03, 0x08, 0x00, 0x0C, 0x00, 0x05 };
+    script(diag_other, sizeof(diag_other));
+    CHECK(!checked.diagnostics(3, MODBUS_DIAG_BUS_MESSAGE_COUNT, 0, &result));
+
+    const uint8_t diag_good[] = { 0x03, 0x08, 0x00, 0x0B, 0x00, 0x05 };
+    script(diag_good, sizeof(diag_good));
+    CHECK(checked.diagnostics(3, MODBUS_DIAG_BUS_MESSAGE_COUNT, 0, &result));
+    CHECK_EQ(result, 5);
+
+    const uint8_t mask_other[] = { 0x03, 0x16, 0x00, 0x04, 0xFF, 0x00, 0x00, 0x35 };
+    script(mask_other, sizeof(mask_other));
+    CHECK(!checked.maskWriteRegister(3, 4, 0xFF00, 0x0034));
+
+    const uint8_t mask_good[] = { 0x03, 0x16, 0x00, 0x04, 0xFF, 0x00, 0x00, 0x34 };
+    script(mask_good, sizeof(mask_good));
+    CHECK(checked.maskWriteRegister(3, 4, 0xFF00, 0x0034));
+}
+
+static bool runToCompletion(ModbusRequest& request) {
+    CHECK(master.submit(request));
+    uint32_t start = millis();
+    while (master.isBusy() && millis() - start < 500) {
+        master.update();
+        wait(1);
+    }
+    return request.ok();
+}
+
+TEST(async_mask_write_read_write_and_diagnostics) {
+    startBus();
+    slave.setHoldingRegister(20, 0x12F0);
+
+    static uint16_t masks[2] = { 0xFF00, 0x0034 };
+    ModbusRequest mask = {};
+    mask.slave = 7;
+    mask.function = MODBUS_FC_MASK_WRITE_REGISTER;
+    mask.address = 20;
+    mask.registers = masks;
+    CHECK(runToCompletion(mask));
+    CHECK_EQ(slave.getHoldingRegister(20), 0x1234);
+
+    static uint16_t written[2] = { 7, 8 };
+    static uint16_t read[2] = {};
+    ModbusRequest read_write = {};
+    read_write.slave = 7;
+    read_write.function = MODBUS_FC_READ_WRITE_REGISTERS;
+    read_write.address = 30;
+    read_write.quantity = 2;
+    read_write.registers = read;
+    read_write.write_address = 30;
+    read_write.write_quantity = 2;
+    read_write.write_registers = written;
+    CHECK(runToCompletion(read_write));
+    CHECK_EQ(read[0], 7);
+    CHECK_EQ(read[1], 8);
+
+    static uint16_t echo = 0xA5A5;
+    ModbusRequest diag = {};
+    diag.slave = 7;
+    diag.function = MODBUS_FC_DIAGNOSTICS;
+    diag.address = MODBUS_DIAG_RETURN_QUERY_DATA;
+    diag.registers = &echo;
+    CHECK(runToCompletion(diag));
+    CHECK_EQ(echo, 0xA5A5);
+}
+
+void main() {
+    host_run_tests();
+}
@@ -0,0 +1,162 @@
+// Modbus TCP server and client over the host loopback interface
+
+#include "ArduLiteESP_MODBUS_TCP.h"
+#include "ArduLiteESP_Task.h"
+#include "host_test.h"
+
+static const uint16_t TEST_PORT = 15502;
+
+static ModbusSlave slave(nullptr, 1);
+static ModbusTCPServer server(&slave, TEST_PORT);
+
+static void startServer() {
+    static bool started = false;
+    if (started) return;
+    started = true;
+
+    CHECK(server.begin());
+    Task([]() {
+        forever() {
+            server.process(10);
+        }
+    }, "tcp server");
+}
+
+static int rawConnect() {
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(TEST_PORT);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+TEST(client_reads_and_writes_over_loopback) {
+    startServer();
+    slave.setHoldingRegister(3, 0xCAFE);
+
+    ModbusTCPClient client(500);
+    CHECK(client.connect("127.0.0.1", TEST_PORT));
+
+    uint16_t values[3] = {};
+    CHECK(client.readHoldingRegisters(1, 3, 2, values));
+    CHECK_EQ(values[0], 0xCAFE);
+
+    uint16_t writes[3] = { 10, 20, 30 };
+    CHECK(client.writeMultipleRegisters(1, 40, 3, writes));
+    CHECK(client.readHoldingRegisters(1, 40, 3, values));
+    CHECK_EQ(values[1], 20);
+
+    CHECK(!client.readHoldingRegisters(1, 255, 2, values));
+    CHECK_EQ(client.getLastException(), MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+}
+
+TEST(short_write_pdu_gets_illegal_data_value) {
+    startServer();
+    int fd = rawConnect();
+    CHECK(fd >= 0);
+
+    // FC16, two registers announced (byte count 4), only two data bytes
+    const uint8_t request[] = { 0x00, 0x01, 0x00, 0x00, 0x00, 0x09, 0x01,
+                                0x10, 0x00, 0x00, 0x00, 0x02, 0x04, 0x12, 0x34 };
+    CHECK(modbus_tcp_send_all(fd, request, sizeof(request)));
+
+    uint8_t reply[16] = {};
+    struct timeval tv = { 2, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    CHECK_EQ(recv(fd, reply, sizeof(reply), MSG_WAITALL), 9);
+    CHECK_EQ(reply[7], 0x90);
+    CHECK_EQ(reply[8], MODBUS_EX_ILLEGAL_DATA_VALUE);
+    CHECK_EQ(slave.getHoldingRegister(0), 0);
+    close(fd);
+}
+
+TEST(client_that_never_reads_is_dropped) {
+    startServer();
+    uint32_t start = millis();
+    while (server.getClientCount() > 0 && millis() - start < 1000) wait(10);
+
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    int small = 4096;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(TEST_PORT);
+    CHECK(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    start = millis();
+    while (server.getClientCount() == 0 && millis() - start < 1000) wait(1);
+    CHECK_EQ(server.getClientCount(), 1);
+
+    // Pipeline 125-register reads (12 bytes in, 259 bytes out) and
+    // never read the replies until the server gives up on us
+    uint8_t request[12] = { 0x00, 0x01, 0x00, 0x00, 0x00, 0x06, 0x01,
+                            0x03, 0x00, 0x00, 0x00, 0x7D };
+    start = millis();
+    bool dropped = false;
+    while (millis() - start < 20000) {
+        if (send(fd, request, sizeof(request), MSG_NOSIGNAL) < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                dropped = true;
+                break;
+            }
+            wait(10);
+        }
+        if (server.getClientCount() == 0) {
+            dropped = true;
+            break;
+        }
+    }
+    close(fd);
+    CHECK(dropped);
+
+    // The server still answers everyone else
+    ModbusTCPClient client(500);
+    CHECK(client.connect("127.0.0.1", TEST_PORT));
+    uint16_t value;
+    CHECK(client.readHoldingRegisters(1, 3, 1, &value));
+}
+
+TEST(server_checks_the_unit_id) {
+    startServer();
+    slave.setHoldingRegister(5, 0x0505);
+
+    ModbusTCPClient client(100);
+    CHECK(client.connect("127.0.0.1", TEST_PORT));
+
+    uint16_t value = 0;
+    CHECK(client.readHoldingRegisters(MODBUS_UNIT_ANY, 5, 1, &value));
+    CHECK_EQ(value, 0x0505);
+    CHECK(client.readHoldingRegisters(0, 5, 1, &value));
+
+    // Another unit behind this address: no reply, the client times out
+    uint32_t start = millis();
+    CHECK(!client.readHoldingRegisters(9, 5, 1, &value));
+    CHECK(millis() - start >= 100);
+    CHECK(client.connected());
+}
+
+TEST(rtu_calls_without_a_uart_do_nothing) {
+    ModbusTCPClient client(50);
+    client.begin();
+    CHECK(!client.enableRS485(4));
+    CHECK_EQ(client.getCharTimeUs(), 0);
+
+    ModbusSlave tcp_only(nullptr, 2);
+    tcp_only.begin();
+    CHECK(!tcp_only.enableRS485(4));
+    tcp_only.process();
+
+    ModbusMaster no_port(nullptr, 50);
+    uint16_t value;
+    CHECK(!no_port.readHoldingRegisters(1, 0, 1, &value));
+}
+
+void main() {
+    host_run_tests();
+}
@@ -0,0 +1,146 @@
+// COBS framing, the incremental packet decoder and UARTPacket over a
+// simulated null-modem cable
+
+#include "ArduLiteESP_Packet.h"
+#include "host_test.h"
+
+#include <atomic>
+#include <vector>
+
+struct Received {
+    uint8_t type;
+    std::vector<uint8_t> payload;
+};
+
+static std::vector<Received> received;
+
+static void collect(uint8_t type, const uint8_t* data, size_t length) {
+    received.push_back({ type, std::vector<uint8_t>(data, data + length) });
+}
+
+static size_t encodeRaw(const uint8_t* data, size_t length, uint8_t* out) {
+    COBSEncoder encoder(out);
+    encoder.put(data, length);
+    return encoder.finish();
+}
+
+TEST(crc_check_value) {
+    CHECK_EQ(PacketCRC16::compute((const uint8_t*)"123456789", 9), 0x29B1);
+}
+
+TEST(cobs_reference_vectors) {
+    uint8_t out[16];
+
+    const uint8_t zero[] = { 0x00 };
+    CHECK_EQ(encodeRaw(zero, sizeof(zero), out), 3);
+    CHECK(memcmp(out, "\x01\x01\x00", 3) == 0);
+
+    const uint8_t zeros[] = { 0x00, 0x00 };
+    CHECK_EQ(encodeRaw(zeros, sizeof(zeros), out), 4);
+    CHECK(memcmp(out, "\x01\x01\x01\x00", 4) == 0);
+
+    const uint8_t mixed[] = { 0x11, 0x22, 0x00, 0x33 };
+    CHECK_EQ(encodeRaw(mixed, sizeof(mixed), out), 6);
+    CHECK(memcmp(out, "\x03\x11\x22\x02\x33\x00", 6) == 0);
+}
+
+TEST(round_trip_in_arbitrary_slices) {
+    static PacketDecoder<512> decoder;
+    received.clear();
+    decoder.setHandler(collect);
+
+    // Every length up to 300, with zero runs and 254-byte blocks
+    std::vector<uint8_t> stream;
+    uint8_t payload[300];
+    uint8_t frame[COBS_MAX_ENCODED_SIZE(300 + PACKET_OVERHEAD)];
+    for (size_t length = 0; length <= 300; length++) {
+        for (size_t i = 0; i < length; i++) payload[i] = (i % 7 == 3) ? 0 : (uint8_t)(i + length);
+        size_t size = packet_encode((uint8_t)length, payload, length, frame);
+        CHECK(size <= sizeof(frame));
+        CHECK(memchr(frame, 0, size - 1) == nullptr);
+        stream.insert(stream.end(), frame, frame + size);
+    }
+
+    uint32_t seed = 1;
+    for (size_t offset = 0; offset < stream.size();) {
+        seed = seed * 1103515245 + 12345;
+        size_t slice = 1 + (seed >> 16) % 97;
+        if (slice > stream.size() - offset) slice = stream.size() - offset;
+        decoder.feed(&stream[offset], slice);
+        offset += slice;
+    }
+
+    CHECK_EQ(decoder.getErrorCount(), 0);
+    CHECK_EQ(received.size(), 301);
+    for (size_t length = 0; length < received.size(); length++) {
+        CHECK_EQ(received[length].type, (uint8_t)length);
+        CHECK_EQ(received[length].payload.size(), length);
+        for (size_t i = 0; i < length; i++) {
+            CHECK_EQ(received[length].payload[i], (i % 7 == 3) ? 0 : (uint8_t)(i + length));
+        }
+    }
+}
+
+TEST(corrupt_and_oversized_frames_are_dropped) {
+    static PacketDecoder<8> decoder;
+    received.clear();
+    decoder.setHandler(collect);
+
+    uint8_t frame[64];
+    const uint8_t data[] = { 1, 2, 3 };
+
+    size_t size = packet_encode(5, data, sizeof(data), frame);
+    frame[2] ^= 0x40;
+    decoder.feed(frame, size);
+    CHECK_EQ(decoder.getErrorCount(), 1);
+
+    const uint8_t big[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    size = packet_encode(5, big, sizeof(big), frame);
+    decoder.feed(frame, size);
+    CHECK_EQ(decoder.getErrorCount(), 2);
+
+    // A frame cut short by a delimiter, then a good one
+    size = packet_encode(6, data, sizeof(data), frame);
+    decoder.feed(frame, 3);
+    decoder.feed((const uint8_t*)"", 1);
+    decoder.feed(frame, size);
+    CHECK_EQ(decoder.getErrorCount(), 3);
+    CHECK_EQ(received.size(), 1);
+    CHECK_EQ(received[0].type, 6);
+    CHECK_EQ(decoder.getFrameCount(), 1);
+}
+
+struct __attribute__((packed)) Sample {
+    uint32_t time;
+    int16_t ax, ay, az;
+};
+
+TEST(uart_packet_over_null_modem) {
+    static std::atomic<int> samples(0);
+    static Sample last;
+
+    host_uart_connect(UART_NUM_1, UART_NUM_2);
+    UARTPacket<> tx(uart1);
+    UARTPacket<> rx(uart2);
+    tx.begin(921600, nullptr);
+    rx.begin(921600, [](uint8_t type, const uint8_t* data, size_t length) {
+        if (type == 1 && UARTPacket<>::read(data, length, last)) samples++;
+    });
+
+    for (int i = 0; i < 100; i++) {
+        Sample sample = { (uint32_t)i, (int16_t)-i, 0, (int16_t)(i * 256) };
+        CHECK(tx.send(1, sample));
+        uart1.waitTxDone();  // The simulated wire delivers instantly
+    }
+    for (int i = 0; i < 500 && samples.load() < 100; i++) wait(1);
+
+    CHECK_EQ(samples.load(), 100);
+    CHECK_EQ(last.time, 99);
+    CHECK_EQ(last.ax, -99);
+    CHECK_EQ(last.az, 99 * 256);
+    CHECK_EQ(rx.getErrorCount(), 0);
+}
+
+void main() {
+    host_run_tests();
+}
@@ -0,0 +1,128 @@
+// WorkerPool on host threads: parallel_for coverage, submit() overflow,
+// groups and restart
+
+#include "ArduLiteESP_Core.h"
+#include "ArduLiteESP_Pool.h"
+#include "host_test.h"
+
+#include <vector>
+
+static bool coveredOnce(WorkerPool& pool, size_t count, size_t grain) {
+    std::vector<std::atomic<uint8_t>> hits(count);
+    for (auto& hit : hits) hit.store(0);
+
+    pool.parallel_for(0, count, [&hits](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) hits[i]++;
+    }, grain);
+
+    for (auto& hit : hits) {
+        if (hit.load() != 1) return false;
+    }
+    return true;
+}
+
+TEST(parallel_for_covers_each_index_once) {
+    static const uint8_t worker_counts[] = { 1, 2, 4 };
+    static const size_t sizes[] = { 1, 7, 100, 4096, 100000 };
+
+    for (uint8_t workers : worker_counts) {
+        WorkerPool pool;
+        CHECK(pool.begin(workers));
+        CHECK_EQ(pool.getWorkerCount(), workers);
+        for (size_t size : sizes) {
+            CHECK(coveredOnce(pool, size, 0));
+            CHECK(coveredOnce(pool, size, 1));  // Deques overflow, the rest runs inline
+        }
+        pool.end();
+    }
+}
+
+TEST(parallel_for_offset_and_empty_ranges) {
+    WorkerPool pool;
+    CHECK(pool.begin(2));
+
+    std::atomic<size_t> sum(0);
+    pool.parallel_for(1000, 2000, [&sum](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) sum += i;
+    });
+    CHECK_EQ(sum.load(), (1000 + 1999) * 1000 / 2);
+
+    bool called = false;
+    pool.parallel_for(5, 5, [&called](size_t, size_t) { called = true; });
+    CHECK(!called);
+}
+
+TEST(submit_runs_everything_before_wait_returns) {
+    WorkerPool pool;
+    CHECK(pool.begin(3));
+
+    // Far more than the deques hold
+    std::atomic<uint32_t> ran(0);
+    WorkGroup group;
+    for (int i = 0; i < 1000; i++) {
+        pool.submit(group, [&ran]() {
+            volatile uint32_t spin = 0;
+            for (int j = 0; j < 1000; j++) spin = spin + j;
+            ran++;
+        });
+    }
+    group.wait();
+    CHECK(group.done());
+    CHECK_EQ(ran.load(), 1000);
+
+    // Groups are reusable after wait()
+    pool.submit(group, [&ran]() { ran++; });
+    group.wait();
+    CHECK_EQ(ran.load(), 1001);
+}
+
+// Callable with a destructor, so Callback moves it through its manager
+struct Counted {
+    static std::atomic<int> live;
+    std::atomic<uint32_t>* ran;
+
+    explicit Counted(std::atomic<uint32_t>* counter) : ran(counter) { live++; }
+    Counted(const Counted& other) : ran(other.ran) { live++; }
+    ~Counted() { live--; }
+    void operator()() const { (*ran)++; }
+};
+std::atomic<int> Counted::live(0);
+
+TEST(submit_destroys_each_callable_once) {
+    std::atomic<uint32_t> ran(0);
+    {
+        WorkerPool pool;
+        CHECK(pool.begin(3));
+        WorkGroup group;
+        for (int i = 0; i < 200; i++) pool.submit(group, Counted(&ran));
+        group.wait();
+        CHECK_EQ(ran.load(), 200);
+    }
+    CHECK_EQ(Counted::live.load(), 0);
+}
+
+TEST(pool_without_workers_runs_inline) {
+    WorkerPool pool;
+    CHECK(coveredOnce(pool, 1000, 0));
+
+    std::atomic<int> ran(0);
+    WorkGroup group;
+    pool.submit(group, [&ran]() { ran++; });
+    CHECK(group.done());
+    group.wait();
+    CHECK_EQ(ran.load(), 1);
+}
+
+TEST(begin_end_restart) {
+    WorkerPool pool;
+    CHECK(pool.begin(2));
+    CHECK(!pool.begin(2));
+    pool.end();
+    CHECK_EQ(pool.getWorkerCount(), 0);
+    CHECK(pool.begin(4));
+    CHECK(coveredOnce(pool, 10000, 0));
+}
+
+void main() {
+    host_run_tests();
+}
@@ -0,0 +1,128 @@
+// SPSCRing and MPSCRing: capacity, ordering, bulk copies across the wrap
+// and cross-thread stress
+
+#include "ArduLiteESP_Core.h"
+#include "ArduLiteESP_Ring.h"
+#include "host_test.h"
+
+#include <thread>
+#include <vector>
+
+TEST(spsc_capacity_and_order) {
+    static SPSCRing<int, 8> ring;
+    CHECK(ring.empty());
+    for (int i = 0; i < 8; i++) CHECK(ring.push(i));
+    CHECK(!ring.push(8));
+    CHECK_EQ(ring.available(), 8);
+    CHECK_EQ(ring.space(), 0);
+
+    int value = -1;
+    for (int i = 0; i < 8; i++) {
+        CHECK(ring.pop(value));
+        CHECK_EQ(value, i);
+    }
+    CHECK(!ring.pop(value));
+    CHECK(ring.empty());
+}
+
+TEST(spsc_bulk_copies_wrap) {
+    static SPSCRing<char, 16> ring;
+    char out[16];
+
+    // Move the indices so every later block straddles the end
+    CHECK_EQ(ring.write("0123456789", 10), 10);
+    CHECK_EQ(ring.read(out, 10), 10);
+
+    CHECK_EQ(ring.write("abcdefghijklmnopqrst", 20), 16);
+    CHECK_EQ(ring.write("x", 1), 0);
+    CHECK_EQ(ring.read(out, 4), 4);
+    CHECK(memcmp(out, "abcd", 4) == 0);
+    CHECK_EQ(ring.write("QRST", 4), 4);
+    CHECK_EQ(ring.read(out, sizeof(out)), 16);
+    CHECK(memcmp(out, "efghijklmnopQRST", 16) == 0);
+    CHECK_EQ(ring.read(out, sizeof(out)), 0);
+}
+
+TEST(spsc_threads_keep_order) {
+    static SPSCRing<uint32_t, 64> ring;
+    const uint32_t count = 1000000;
+
+    std::thread producer([count]() {
+        for (uint32_t i = 0; i < count;) {
+            if (ring.push(i)) i++;
+            else std::this_thread::yield();
+        }
+    });
+
+    uint32_t expected = 0;
+    bool ordered = true;
+    uint32_t value;
+    while (expected < count) {
+        if (ring.pop(value)) {
+            if (value != expected) ordered = false;
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    CHECK(ordered);
+    CHECK(ring.empty());
+}
+
+TEST(mpsc_capacity_and_order) {
+    static MPSCRing<int, 4> ring;
+    for (int i = 0; i < 4; i++) CHECK(ring.push(i));
+    CHECK(!ring.push(4));
+
+    int value = -1;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 4; i++) {
+            CHECK(ring.pop(value));
+            CHECK_EQ(value, round * 4 + i);
+            CHECK(ring.push(round * 4 + i + 4));
+        }
+    }
+}
+
+TEST(mpsc_producers_lose_nothing) {
+    static MPSCRing<uint32_t, 256> ring;
+    const int producers = 4;
+    const uint32_t per_producer = 250000;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([p, per_producer]() {
+            for (uint32_t i = 0; i < per_producer;) {
+                if (ring.push(((uint32_t)p << 24) | i)) i++;
+                else std::this_thread::yield();
+            }
+        });
+    }
+
+    // Each producer's values must arrive in its own order
+    uint32_t next[producers] = {};
+    bool ordered = true;
+    uint32_t received = 0;
+    uint32_t value;
+    while (received < producers * per_producer) {
+        if (ring.pop(value)) {
+            uint32_t p = value >> 24;
+            if (p >= (uint32_t)producers || (value & 0xFFFFFF) != next[p]) ordered = false;
+            else next[p]++;
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    CHECK(ordered);
+    for (int p = 0; p < producers; p++) CHECK_EQ(next[p], per_producer);
+    CHECK(!ring.pop(value));
+}
+
+void main() {
+    host_run_tests();
+}
@@ -0,0 +1,155 @@
+// Cooperative scheduler: wake order of sleeping jobs, removal, capacity
+// and the notify() path for JOB_WAIT_UNTIL()
+
+#include "ArduLiteESP_Scheduler.h"
+#include "host_test.h"
+
+#include <atomic>
+#include <vector>
+
+static std::vector<int> woken;
+
+class Sleeper : public Job {
+    int id;
+    uint32_t ms;
+
+public:
+    Sleeper(int i = 0, uint32_t period = 0) : id(i), ms(period) {}
+
+    void set(int i, uint32_t period) {
+        id = i;
+        ms = period;
+    }
+
+    void run() override {
+        JOB_BEGIN();
+        JOB_SLEEP(ms);
+        woken.push_back(id);
+        JOB_END();
+    }
+};
+
+// Steps of 100 ms, so a millisecond that ticks over during a pass
+// cannot reorder jobs
+static void advance(Scheduler& scheduler, int steps) {
+    for (int i = 0; i < steps; i++) {
+        host_clock_advance_us(100000);
+        scheduler.runOnce();
+    }
+}
+
+TEST(sleepers_wake_in_time_order) {
+    Scheduler scheduler;
+    static Sleeper jobs[40];
+    woken.clear();
+
+    uint32_t seed = 7;
+    for (int i = 0; i < 40; i++) {
+        seed = seed * 1103515245 + 12345;
+        jobs[i].set(i, 100 * (1 + (seed >> 16) % 12));  // Plenty of ties
+        CHECK(scheduler.add(jobs[i]));
+    }
+    scheduler.runOnce();
+    CHECK(woken.empty());
+
+    advance(scheduler, 13);
+    CHECK_EQ(woken.size(), 40);
+    CHECK_EQ(scheduler.getJobCount(), 0);
+
+    // Sorted by period, ties in the order the jobs went to sleep
+    seed = 7;
+    uint32_t periods[40];
+    for (int i = 0; i < 40; i++) {
+        seed = seed * 1103515245 + 12345;
+        periods[i] = 1 + (seed >> 16) % 12;
+    }
+    for (size_t i = 1; i < woken.size(); i++) {
+        int a = woken[i - 1], b = woken[i];
+        CHECK(periods[a] < periods[b] || (periods[a] == periods[b] && a < b));
+    }
+}
+
+TEST(removed_sleepers_never_wake) {
+    Scheduler scheduler;
+    static Sleeper jobs[10];
+    woken.clear();
+
+    for (int i = 0; i < 10; i++) {
+        jobs[i].set(i, 100 * (10 - i));
+        CHECK(scheduler.add(jobs[i]));
+    }
+    scheduler.runOnce();
+
+    scheduler.remove(jobs[9]);  // Heap root
+    scheduler.remove(jobs[3]);
+    scheduler.remove(jobs[0]);  // Latest
+    CHECK_EQ(scheduler.getJobCount(), 7);
+    CHECK(!jobs[3].scheduled());
+
+    advance(scheduler, 11);
+    const int expected[] = { 8, 7, 6, 5, 4, 2, 1 };
+    CHECK_EQ(woken.size(), 7);
+    for (size_t i = 0; i < woken.size() && i < 7; i++) CHECK_EQ(woken[i], expected[i]);
+}
+
+TEST(add_fails_beyond_max_jobs) {
+    Scheduler scheduler;
+    static Sleeper jobs[SCHEDULER_MAX_JOBS + 1];
+
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        jobs[i].set(i, 100);
+        CHECK(scheduler.add(jobs[i]));
+    }
+    CHECK(!scheduler.add(jobs[SCHEDULER_MAX_JOBS]));
+
+    scheduler.runOnce();  // All asleep, the heap is full
+    scheduler.remove(jobs[5]);
+    CHECK(scheduler.add(jobs[SCHEDULER_MAX_JOBS]));
+
+    for (int i = 0; i <= SCHEDULER_MAX_JOBS; i++) scheduler.remove(jobs[i]);
+    CHECK_EQ(scheduler.getJobCount(), 0);
+}
+
+static std::atomic<bool> ready(false);
+static std::atomic<int64_t> woke_us(0);
+
+class Waiter : public Job {
+public:
+    void run() override {
+        JOB_BEGIN();
+        forever() {
+            JOB_WAIT_UNTIL(ready.load());
+            ready = false;
+            woke_us = esp_timer_get_time();
+        }
+        JOB_END();
+    }
+};
+
+TEST(notify_ends_the_poll_wait) {
+    static Scheduler background;
+    static Waiter waiter;
+    CHECK(background.add(waiter));
+    background.begin();
+    wait(20);
+
+    int64_t worst_us = 0;
+    for (int round = 0; round < 5; round++) {
+        wait(3 + round);
+        int64_t set_us = esp_timer_get_time();
+        ready = true;
+        background.notify();
+
+        for (int i = 0; i < 100 && woke_us.load() < set_us; i++) wait(1);
+        int64_t latency = woke_us.load() - set_us;
+        if (latency > worst_us) worst_us = latency;
+    }
+
+    // Without the notification this averages SCHEDULER_POLL_MS / 2
+    CHECK(worst_us >= 0);
+    CHECK(worst_us < 3000);
+}
+
+void main() {
+    host_run_tests();
+}
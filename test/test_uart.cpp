@@ -0,0 +1,145 @@
+// UART receive path: chunked driver reads split into lines by the RX task
+
+#include "ArduLiteESP_UART.h"
+#include "host_test.h"
+
+#include <float.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+static std::mutex lines_lock;
+static std::vector<std::string> lines;
+
+static void collect(const char* line, size_t length) {
+    CHECK_EQ(strlen(line), length);
+    std::lock_guard<std::mutex> lock(lines_lock);
+    lines.emplace_back(line, length);
+}
+
+static size_t waitLines(size_t count) {
+    for (int i = 0; i < 500; i++) {
+        {
+            std::lock_guard<std::mutex> lock(lines_lock);
+            if (lines.size() >= count) break;
+        }
+        wait(1);
+    }
+    wait(10);  // Catch any extra deliveries
+    std::lock_guard<std::mutex> lock(lines_lock);
+    return lines.size();
+}
+
+static void inject(const char* text) {
+    host_uart_inject(UART_NUM_1, text, strlen(text));
+}
+
+TEST(several_lines_in_one_chunk) {
+    lines.clear();
+    UART port(UART_NUM_1);
+    port.onLine(collect);
+    port.begin(115200);
+
+    inject("one\ntwo\r\nthree\r\n\nfour\r");
+    CHECK_EQ(waitLines(4), 4);
+    CHECK_STR(lines[0].c_str(), "one");
+    CHECK_STR(lines[1].c_str(), "two");
+    CHECK_STR(lines[2].c_str(), "three");
+    CHECK_STR(lines[3].c_str(), "four");
+}
+
+TEST(lines_span_driver_reads) {
+    lines.clear();
+    UART port(UART_NUM_1);
+    port.onLine(collect);
+    port.begin(115200);
+
+    inject("hel");
+    wait(20);
+    inject("lo\n");
+    CHECK_EQ(waitLines(1), 1);
+    CHECK_STR(lines[0].c_str(), "hello");
+
+    // 50-character lines straddle the 128-byte RX chunks
+    std::string block;
+    for (int i = 0; i < 10; i++) {
+        block += std::string(49, (char)('a' + i));
+        block += '\n';
+    }
+    inject(block.c_str());
+    CHECK_EQ(waitLines(11), 11);
+    for (int i = 0; i < 10; i++) {
+        CHECK_EQ(lines[1 + i].size(), 49);
+        CHECK_EQ(lines[1 + i][48], 'a' + i);
+    }
+}
+
+TEST(overflow_truncate_skips_rest_of_line) {
+    lines.clear();
+    static char small[8];
+    UART port(UART_NUM_1);
+    port.setLineBuffer(small);
+    port.setOverflowPolicy(UART::OVERFLOW_TRUNCATE);
+    port.onLine(collect);
+    port.begin(115200);
+
+    inject("abcdefghij\nxy\n");
+    CHECK_EQ(waitLines(2), 2);
+    CHECK_STR(lines[0].c_str(), "abcdefg");
+    CHECK_STR(lines[1].c_str(), "xy");
+}
+
+TEST(line_queue_hands_lines_to_a_poller) {
+    static UART::LineQueue queue;
+    UART port(UART_NUM_1);
+    port.setLineQueue(queue);
+    port.begin(115200);
+
+    inject("first\r\nsecond\n");
+
+    char line[16];
+    uint32_t start = millis();
+    while (!port.readLine(line, sizeof(line)) && millis() - start < 500) wait(1);
+    CHECK_STR(line, "first");
+    while (!port.readLine(line, sizeof(line)) && millis() - start < 500) wait(1);
+    CHECK_STR(line, "second");
+    CHECK(!port.readLine(line, sizeof(line)));
+}
+
+TEST(format_float_matches_printf) {
+    static const float values[] = { 0.0f, 1.0f, -1.5f, 0.125f, 2.675f, 123.456f,
+                                    -98765.4321f, 1e-7f, 3999999744.0f };
+    char expected[64];
+    char out[UART::FLOAT_BUF_SIZE];
+
+    for (float value : values) {
+        for (uint8_t decimals = 0; decimals <= UART::FLOAT_MAX_DECIMALS; decimals++) {
+            int length = snprintf(expected, sizeof(expected), "%.*f", decimals, (double)value);
+            CHECK_EQ(UART::formatFloat(value, decimals, out), length);
+            CHECK_STR(out, expected);
+        }
+    }
+}
+
+TEST(format_float_keeps_sign_and_fits_large_values) {
+    char out[UART::FLOAT_BUF_SIZE];
+
+    CHECK_EQ(UART::formatFloat(-0.0f, 2, out), 5);
+    CHECK_STR(out, "-0.00");
+
+    UART::formatFloat(-FLT_MAX, 2, out);
+    CHECK_STR(out, "-3.40e+38");
+    UART::formatFloat(4.0e9f, 0, out);
+    CHECK_STR(out, "4e+09");
+
+    // Decimals beyond a float's precision are capped
+    size_t length = UART::formatFloat(-FLT_MAX, 255, out);
+    CHECK_EQ(length, strlen(out));
+    CHECK_STR(out, "-3.402823466e+38");
+    CHECK_EQ(UART::formatFloat(-1234567890.0f, 255, out), strlen("-1234567936.000000000"));
+    CHECK_STR(out, "-1234567936.000000000");
+}
+
+void main() {
+    host_run_tests();
+}
@@ -0,0 +1,136 @@
+// TimerWheel driven by explicit instants, including the point where
+// the 32-bit millisecond clock wraps
+
+#include "ArduLiteESP_TimerWheel.h"
+#include "ArduLiteESP_WheelIO.h"
+#include "host_test.h"
+
+#include <type_traits>
+
+static_assert(!std::is_copy_constructible<SoftTimer>::value, "SoftTimer copyable");
+static_assert(!std::is_copy_assignable<SoftTimer>::value, "SoftTimer assignable");
+
+static int fired_once = 0;
+static int fired_every = 0;
+
+// Instants on 10 ms tick boundaries, starting `base_ms` into the clock
+static void run(TimerWheel& timers, int64_t base_ms, int ticks) {
+    for (int i = 1; i <= ticks; i++) {
+        timers.update(Instant((base_ms + 10 * i) * 1000 + 500));
+    }
+}
+
+// As run(), but also moves the clock that Button debounces against
+static void step(TimerWheel& timers, int64_t base_ms, int ticks) {
+    for (int i = 1; i <= ticks; i++) {
+        int64_t t_us = (base_ms + 10 * i) * 1000 + 500;
+        host_clock_set_us(t_us);
+        timers.update(Instant(t_us));
+    }
+}
+
+TEST(once_and_every) {
+    const int64_t base_ms = 10000;
+    host_clock_set_us(base_ms * 1000 + 500);
+
+    TimerWheel timers(10);
+    SoftTimer once([]() { fired_once++; });
+    SoftTimer every([]() { fired_every++; });
+    timers.once(once, 50);
+    timers.every(every, 20);
+
+    run(timers, base_ms, 100);  // One second
+    CHECK_EQ(fired_once, 1);
+    CHECK_EQ(fired_every, 50);
+    CHECK(!once.isActive());
+
+    every.stop();
+    run(timers, base_ms + 1000, 10);
+    CHECK_EQ(fired_every, 50);
+    CHECK_EQ(timers.getActiveCount(), 0);
+}
+
+TEST(ticks_continue_across_millis_wrap) {
+    // 200 ms before millis() wraps after 2^32 ms (49.7 days)
+    const int64_t base_ms = (1LL << 32) - 200;
+    host_clock_set_us(base_ms * 1000 + 500);
+
+    fired_every = 0;
+    TimerWheel timers(10);
+    SoftTimer every([]() { fired_every++; });
+    timers.every(every, 20);
+
+    run(timers, base_ms, 100);  // 200 ms before the wrap, 800 ms after
+    CHECK_EQ(fired_every, 50);
+
+    fired_once = 0;
+    SoftTimer once([]() { fired_once++; });
+    timers.once(once, 100);
+    run(timers, base_ms + 1000, 9);
+    CHECK_EQ(fired_once, 0);
+    run(timers, base_ms + 1090, 2);
+    CHECK_EQ(fired_once, 1);
+}
+
+TEST(wheel_led_blinks_without_update) {
+    const int64_t base_ms = 20000;
+    host_clock_set_us(base_ms * 1000 + 500);
+
+    TimerWheel timers(10);
+    LED led(5);
+    WheelLED blinker(led);
+    CHECK(!host_gpio_get_output(5));
+
+    blinker.blink(50, timers);
+    CHECK(blinker.isBlinking());
+    CHECK(!led.isBlinking());
+    step(timers, base_ms, 5);
+    CHECK(host_gpio_get_output(5));
+    step(timers, base_ms + 50, 5);
+    CHECK(!host_gpio_get_output(5));
+
+    blinker.on();
+    CHECK(!blinker.isBlinking());
+    step(timers, base_ms + 100, 20);
+    CHECK(host_gpio_get_output(5));
+    CHECK_EQ(timers.getActiveCount(), 0);
+}
+
+TEST(wheel_button_latches_debounced_edges) {
+    const int64_t base_ms = 30000;
+    host_clock_set_us(base_ms * 1000 + 500);
+    host_gpio_set_input(34, true);  // Released (pull-up)
+
+    TimerWheel timers(10);
+    Button btn(34, IN_PULLUP, 50);
+    WheelButton button(btn);
+    button.attach(timers);
+    CHECK(button.isAttached());
+
+    // A short glitch is filtered
+    host_gpio_set_input(34, false);
+    step(timers, base_ms, 2);
+    host_gpio_set_input(34, true);
+    step(timers, base_ms + 20, 10);
+    CHECK(!button.pressed());
+    CHECK(!button.isPressed());
+
+    // A held press is reported once, then the release
+    host_gpio_set_input(34, false);
+    step(timers, base_ms + 120, 10);
+    CHECK(button.isPressed());
+    CHECK(button.pressed());
+    CHECK(!button.pressed());
+    host_gpio_set_input(34, true);
+    step(timers, base_ms + 220, 10);
+    CHECK(!button.isPressed());
+    CHECK(button.released());
+    CHECK(!button.released());
+
+    button.detach();
+    CHECK_EQ(timers.getActiveCount(), 0);
+}
+
+void main() {
+    host_run_tests();
+}